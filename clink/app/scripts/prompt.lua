@@ -5,9 +5,70 @@
 clink = clink or {}
 local prompt_filters = {}
 local prompt_filters_unsorted = false
+local prompt_job = nil
 
 
 
+--------------------------------------------------------------------------------
+-- Filters are identified in timings by where their filter() is defined.
+local function get_name(filter)
+    if not filter._name then
+        local func = filter.filter
+        if type(func) == "function" then
+            local info = debug.getinfo(func, "S")
+            filter._name = info.short_src .. ":" .. info.linedefined
+        else
+            filter._name = tostring(filter)
+        end
+    end
+
+    return filter._name
+end
+
+--------------------------------------------------------------------------------
+-- Only io.popen2async() handles are waited on. Other userdata yielded may not
+-- be indexable, so the handles' metatable is checked for instead.
+local function is_async_handle(value)
+    if type(value) ~= "userdata" then
+        return false
+    end
+
+    local mt = getmetatable(value)
+    return mt ~= nil and mt == debug.getregistry().popen2async_mt
+end
+
+--------------------------------------------------------------------------------
+local function resume_prompt_job()
+    local job = prompt_job
+
+    -- Track how long the filters spend suspended so it isn't counted towards
+    -- their timings.
+    if job.yielded then
+        job.suspended = job.suspended + clink.clock() - job.yielded
+    end
+
+    local ok, ret = coroutine.resume(job.co)
+    if not ok then
+        print("")
+        print(ret)
+        print(debug.traceback(job.co))
+        ret = "\nPROMPT_LUA_ERROR>"
+    end
+
+    if coroutine.status(job.co) == "dead" then
+        prompt_job = nil
+        return ret
+    end
+
+    if is_async_handle(ret) then
+        job.wait = ret
+    else
+        job.wait = nil
+    end
+
+    job.yielded = clink.clock()
+end
+
 --------------------------------------------------------------------------------
 function clink._filter_prompt(prompt)
     -- Sort by priority if required.
@@ -18,34 +79,67 @@ function clink._filter_prompt(prompt)
         prompt_filters_unsorted = false
     end
 
-    -- Protected call to prompt filters.
-    local impl = function(prompt)
+    -- Filters run in a coroutine so they can yield while they wait on things
+    -- like child processes. If they do then nil is returned and the filtered
+    -- prompt is collected later with clink._resume_prompt().
+    local job = { suspended = 0 }
+    local impl = function()
         for _, filter in ipairs(prompt_filters) do
-            local filtered, onwards = filter:filter(prompt)
-            if filtered ~= nil then
-                if onwards == false then return filtered end
-                prompt = filtered
+            local name = get_name(filter)
+            if not clink._isskipped(name) then
+                local start = clink.clock() - job.suspended
+                local filtered, onwards = filter:filter(prompt)
+                clink._recordtiming(name, clink.clock() - job.suspended - start)
+                if filtered ~= nil then
+                    if onwards == false then return filtered end
+                    prompt = filtered
+                end
             end
         end
 
         return prompt
     end
 
-    local ok, ret = pcall(impl, prompt)
-    if not ok then
-        print("")
-        print(ret)
-        print(debug.traceback())
-        return "\nPROMPT_LUA_ERROR>"
+    job.co = coroutine.create(impl)
+    prompt_job = job
+    return resume_prompt_job()
+end
+
+--------------------------------------------------------------------------------
+function clink._resume_prompt(wait)
+    if prompt_job == nil then
+        return
     end
 
-    return ret
+    -- Filters that yielded an io.popen2async() handle are only resumed once
+    -- it's ready, unless the caller's happy to block until they've finished.
+    repeat
+        local job = prompt_job
+        if job.wait and not job.wait:ready() then
+            if not wait then
+                return
+            end
+
+            io.waitany(job.wait)
+        end
+
+        local ret = resume_prompt_job()
+        if ret ~= nil then
+            return ret
+        end
+    until not wait
 end
 
 --------------------------------------------------------------------------------
 --- -name:  clink.promptfilter
 --- -arg:   [priority:integer]
 --- -ret:   table
+--- Prompt filters' filter() functions are run as a coroutine and can call
+--- coroutine.yield() while they wait on something like a child process,
+--- yielding an io.popen2async() handle to be resumed once it has output. The
+--- prompt from the last time the current directory was shown is drawn in the
+--- meantime and is replaced when the filters finish. Filters that repeatedly
+--- take longer than the 'lua.budget' setting to run are skipped.
 function clink.promptfilter(priority)
     if priority == nil then priority = 999 end
 
@@ -53,3 +147,57 @@ function clink.promptfilter(priority)
     table.insert(prompt_filters, ret)
     return ret
 end
+
+
+
+--------------------------------------------------------------------------------
+local prompt_cache = {}
+prompt_cache.__index = prompt_cache
+
+--------------------------------------------------------------------------------
+--- -name:  promptcache:get
+--- -arg:   func:function
+--- -ret:   any
+--- Returns the value cached for the current key. If there isn't one, or it has
+--- gone stale, then func(key) is called and what it returns is cached. Values
+--- can be strings, numbers, booleans or nil.
+function prompt_cache:get(func)
+    -- The key function returns a key followed by the files the value depends
+    -- on. Without a key the value isn't cached.
+    local key = table.pack(self._key_func())
+    if key[1] == nil then
+        return func()
+    end
+
+    local id = self._id .. ":" .. tostring(key[1])
+    local found, value = clink._getpromptfragment(id, self._ttl, table.unpack(key, 2, key.n))
+    if found then
+        return value
+    end
+
+    value = func(key[1])
+    clink._setpromptfragment(id, value, table.unpack(key, 2, key.n))
+    return value
+end
+
+--------------------------------------------------------------------------------
+--- -name:  clink.promptcache
+--- -arg:   key_func:function
+--- -arg:   [ttl:number]
+--- -ret:   table
+--- Creates a cache for values that are expensive for prompt filters to work
+--- out. The values are kept between prompts. key_func() returns the key the
+--- value is cached under (the current directory for example) and then any files
+--- that would change the value if they were modified, such as '.git/HEAD'. An
+--- entry is also refreshed once it's older than 'ttl' seconds, if given.
+--- Caches are told apart by where they are created, so values carry over to
+--- the same cache when the scripts are reloaded.
+function clink.promptcache(key_func, ttl)
+    -- Values outlive the Lua state so caches are identified by something that
+    -- is the same each time the scripts are loaded.
+    local info = debug.getinfo(2, "Sl")
+    local id = info.short_src .. ":" .. info.currentline
+
+    local ret = { _id = id, _key_func = key_func, _ttl = ttl }
+    return setmetatable(ret, prompt_cache)
+end
@@ -28,10 +28,15 @@ local function set_handler(word_index, line_state)
         name = line_state:getword(word_index - 1)
     end
 
+    -- Let other generators run while the child process starts up.
+    local file = io.popen('"'..CLINK_EXE..'" set --list '..name, "r")
+    coroutine.yield()
+
     local ret = {}
-    for line in io.popen('"'..CLINK_EXE..'" set --list '..name, "r"):lines() do
+    for line in file:lines() do
         table.insert(ret, line)
     end
+    file:close()
 
     return ret
 end
@@ -16,12 +16,15 @@
 #include <core/str.h>
 #include <core/str_compare.h>
 #include <core/str_tokeniser.h>
+#include <core/trace.h>
 #include <lib/match_generator.h>
 #include <lib/line_editor.h>
 #include <lua/lua_script_loader.h>
 #include <lua/lua_state.h>
 #include <lua/lua_match_generator.h>
+#include <lua/script_stats.h>
 #include <terminal/terminal.h>
+#include <terminal/terminal_in.h>
 
 extern "C" {
 #include <lua.h>
@@ -42,6 +45,19 @@ static SettingBool g_add_history_cmd(
     "Toggles the adding of 'history' commands to the history.",
     true);
 
+#if defined(CLINK_TRACE)
+static SettingBool g_trace(
+    "log.trace",
+    "Save each line's timings",
+    "When enabled, the timings recorded while each line is edited are saved for\n"
+    "'clink info --trace' to print.",
+    false);
+#endif
+
+// How often input is polled for while a prompt is being filtered or matches are
+// being generated.
+static const int32 g_poll_ms = 50;
+
 
 
 //------------------------------------------------------------------------------
@@ -85,7 +101,7 @@ bool Host::edit_line(const char* prompt, StrBase& out)
 
     // Set up Lua and load scripts into it.
     HostLua lua;
-    PromptFilter prompt_filter(lua);
+    PromptFilter prompt_filter(lua, _prompt_cache);
     initialise_lua(lua);
     lua.load_scripts();
 
@@ -97,7 +113,8 @@ bool Host::edit_line(const char* prompt, StrBase& out)
     LineEditor::Desc desc = {};
     initialise_editor_desc(desc);
 
-    // Filter the prompt.
+    // Filter the prompt. If that's going to take a while it may be a stale one
+    // that's shown to begin with.
     Str<256> filtered_prompt;
     prompt_filter.filter(prompt, filtered_prompt);
     desc.prompt = filtered_prompt.c_str();
@@ -125,10 +142,25 @@ bool Host::edit_line(const char* prompt, StrBase& out)
     _history.initialise();
     _history.load_rl_history();
 
+    // Edit the line. Input is polled while the prompt filters or generators are
+    // still running so the editor can repaint as soon as they've finished.
+    auto edit = [&] () {
+        while (editor->update())
+        {
+            if (prompt_filter.resume(filtered_prompt))
+                editor->set_prompt(filtered_prompt.c_str());
+
+            bool pending = prompt_filter.is_pending() || editor->is_pending();
+            terminal.in->select(pending ? g_poll_ms : -1);
+        }
+
+        return editor->get_line(out.data(), out.size());
+    };
+
     bool ret = false;
     while (1)
     {
-        if (ret = editor->edit(out.data(), out.size()))
+        if (ret = edit())
         {
             // Handle history event expansion.
             if (_history.expand(out.c_str(), out) == HistoryDb::expand_print)
@@ -157,5 +189,21 @@ bool Host::edit_line(const char* prompt, StrBase& out)
     line_editor_destroy(editor);
     tab_completer_destroy(completer);
     terminal_destroy(terminal);
+
+    // Scripts' timings are kept for 'clink info' to show.
+    Str<288> stats_file;
+    app->get_script_stats_path(stats_file);
+    ScriptStats::get().save(stats_file.c_str());
+
+#if defined(CLINK_TRACE)
+    // Leave the line's timings where 'clink info --trace' can find them.
+    if (g_trace.get())
+    {
+        Str<288> trace_file;
+        app->get_trace_path(trace_file);
+        trace::dump(trace_file.c_str());
+    }
+#endif
+
     return ret;
 }
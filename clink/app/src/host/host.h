@@ -4,6 +4,7 @@
 #pragma once
 
 #include "history/history_db.h"
+#include "prompt.h"
 
 #include <lib/line_editor.h>
 
@@ -29,4 +30,5 @@ private:
     void            filter_prompt(const char* in, StrBase& out);
     const char*     _name;
     HistoryDb       _history;
+    PromptCache     _prompt_cache;
 };
@@ -264,7 +264,7 @@ void HostCmd::edit_line(const wchar_t* prompt, wchar_t* chars, int32 max_chars)
     // Call readline.
     while (1)
     {
-        Str<4096> out;
+        Str<> out;
         bool ok = Host::edit_line(utf8_prompt.c_str(), out);
         if (ok)
         {
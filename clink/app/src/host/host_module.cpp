@@ -307,3 +307,8 @@ void HostModule::on_input(const Input& Input, Result& result, const Context& con
 void HostModule::on_terminal_resize(int32 columns, int32 rows, const Context& context)
 {
 }
+
+//------------------------------------------------------------------------------
+void HostModule::on_prompt_changed(const Context& context)
+{
+}
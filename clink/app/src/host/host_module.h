@@ -17,6 +17,7 @@ public:
     virtual void    on_matches_changed(const Context& context) override;
     virtual void    on_input(const Input& Input, Result& result, const Context& context) override;
     virtual void    on_terminal_resize(int32 columns, int32 rows, const Context& context) override;
+    virtual void    on_prompt_changed(const Context& context) override;
 
 private:
     const char*     _host_name;
@@ -5,7 +5,9 @@
 #include "prompt.h"
 
 #include <core/base.h>
+#include <core/os.h>
 #include <core/str.h>
+#include <core/trace.h>
 #include <lua/lua_script_loader.h>
 #include <lua/lua_state.h>
 
@@ -147,17 +149,187 @@ int32 TaggedPrompt::is_tagged(const wchar_t* chars, int32 char_count)
 
 
 //------------------------------------------------------------------------------
-PromptFilter::PromptFilter(LuaState& lua)
+template <typename T, int32 N>
+static T* find_entry(T (&entries)[N], const char* key)
+{
+    for (T& entry : entries)
+        if (entry.tick && entry.key.iequals(key))
+            return &entry;
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+template <typename T, int32 N>
+static T* get_slot(T (&entries)[N], const char* key)
+{
+    // Reuse the entry for 'key' if there is one, otherwise the oldest.
+    if (T* entry = find_entry(entries, key))
+        return entry;
+
+    T* slot = entries;
+    for (T& entry : entries)
+        if (entry.tick < slot->tick)
+            slot = &entry;
+
+    slot->key = key;
+    return slot;
+}
+
+
+
+//------------------------------------------------------------------------------
+const char* PromptCache::get(const char* cwd) const
+{
+    if (const Entry* entry = find_entry(_entries, cwd))
+        return entry->prompt.c_str();
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+void PromptCache::set(const char* cwd, const char* prompt)
+{
+    Entry* slot = get_slot(_entries, cwd);
+    slot->prompt = prompt;
+    slot->tick = ++_tick;
+}
+
+//------------------------------------------------------------------------------
+const PromptCache::Fragment* PromptCache::get_fragment(const char* key, uint64 stamp, uint32 ttl_ms)
+{
+    Fragment* fragment = find_entry(_fragments, key);
+    if (fragment == nullptr || fragment->stamp != stamp)
+        return nullptr;
+
+    if (ttl_ms && GetTickCount() - fragment->time >= ttl_ms)
+        return nullptr;
+
+    fragment->tick = ++_tick;
+    return fragment;
+}
+
+//------------------------------------------------------------------------------
+void PromptCache::set_fragment(const char* key, uint64 stamp, int32 type, const char* value, double number)
+{
+    Fragment* slot = get_slot(_fragments, key);
+    slot->value = value;
+    slot->number = number;
+    slot->stamp = stamp;
+    slot->type = type;
+    slot->time = GetTickCount();
+    slot->tick = ++_tick;
+}
+
+
+
+//------------------------------------------------------------------------------
+static uint64 get_files_stamp(lua_State* state, int32 first)
+{
+    uint64 stamp = 0;
+    for (int32 i = first, n = lua_gettop(state); i <= n; ++i)
+        if (const char* path = lua_tostring(state, i))
+            stamp = (stamp * 0x100000001b3ull) ^ os::get_file_stamp(path);
+
+    return stamp;
+}
+
+//------------------------------------------------------------------------------
+// clink._getpromptfragment(key, ttl, files...) -> found, value
+static int32 get_prompt_fragment(lua_State* state)
+{
+    auto* cache = (PromptCache*)lua_touserdata(state, lua_upvalueindex(1));
+    const char* key = luaL_checkstring(state, 1);
+    double ttl = max(double(lua_tonumber(state, 2)), 0.0);
+    uint64 stamp = get_files_stamp(state, 3);
+
+    const PromptCache::Fragment* fragment = cache->get_fragment(key, stamp, uint32(ttl * 1000));
+    if (fragment == nullptr)
+        return 0;
+
+    lua_pushboolean(state, 1);
+
+    const char* value = fragment->value.c_str();
+    switch (fragment->type)
+    {
+    case LUA_TBOOLEAN:  lua_pushboolean(state, *value != '\0');          break;
+    case LUA_TNUMBER:   lua_pushnumber(state, fragment->number);         break;
+    case LUA_TSTRING:   lua_pushstring(state, value);                    break;
+    default:            lua_pushnil(state);                              break;
+    }
+
+    return 2;
+}
+
+//------------------------------------------------------------------------------
+// clink._setpromptfragment(key, value, files...)
+static int32 set_prompt_fragment(lua_State* state)
+{
+    auto* cache = (PromptCache*)lua_touserdata(state, lua_upvalueindex(1));
+    const char* key = luaL_checkstring(state, 1);
+
+    // Numbers are kept as they are; going via text would lose precision.
+    const char* value = "";
+    double number = 0;
+    int32 type = lua_type(state, 2);
+    switch (type)
+    {
+    case LUA_TNIL:                                                      break;
+    case LUA_TBOOLEAN:  value = lua_toboolean(state, 2) ? "1" : "";     break;
+    case LUA_TNUMBER:   number = double(lua_tonumber(state, 2));        break;
+    case LUA_TSTRING:   value = lua_tostring(state, 2);                 break;
+    default:            return 0;
+    }
+
+    cache->set_fragment(key, get_files_stamp(state, 3), type, value, number);
+    return 0;
+}
+
+
+
+//------------------------------------------------------------------------------
+PromptFilter::PromptFilter(LuaState& lua, PromptCache& cache)
 : _lua(lua)
+, _cache(cache)
 {
     lua_load_script(lua, app, prompt);
+
+    struct {
+        const char* name;
+        int32       (*method)(lua_State*);
+    } methods[] = {
+        { "_getpromptfragment", &get_prompt_fragment },
+        { "_setpromptfragment", &set_prompt_fragment },
+    };
+
+    // The cache outlives Lua states so what's in it is available to each new
+    // state's prompt filters.
+    lua_State* state = lua.get_state();
+
+    lua_getglobal(state, "clink");
+
+    for (const auto& method : methods)
+    {
+        lua_pushstring(state, method.name);
+        lua_pushlightuserdata(state, &cache);
+        lua_pushcclosure(state, method.method, 1);
+        lua_rawset(state, -3);
+    }
+
+    lua_pop(state, 1);
 }
 
 //------------------------------------------------------------------------------
 void PromptFilter::filter(const char* in, StrBase& out)
 {
+    TRACE_SCOPE("Lua: clink._filter_prompt");
+
     lua_State* state = _lua.get_state();
 
+    os::get_current_dir(_cwd);
+    _unfiltered = in;
+    _pending = false;
+
     // Call Lua to filter prompt
     lua_getglobal(state, "clink");
     lua_pushliteral(state, "_filter_prompt");
@@ -165,18 +337,99 @@ void PromptFilter::filter(const char* in, StrBase& out)
 
     lua_pushstring(state, in);
 
-    if (lua_pcall(state, 1, 1, 0) != 0)
+    int32 result = call(1, out);
+    if (result == call_done)
+    {
+        _cache.set(_cwd.c_str(), out.c_str());
+        return;
+    }
+
+    // A failure is reported by call(). The prompt's shown as it was given and
+    // the cache is left as it was.
+    if (result == call_failed)
+    {
+        out = in;
+        return;
+    }
+
+    // The filters are waiting on something. Meanwhile the prompt from the last
+    // time this directory was shown is used. Without one we've little choice
+    // but to wait for them.
+    _pending = true;
+    if (const char* cached = _cache.get(_cwd.c_str()))
+        out = cached;
+    else
+        resume(out, true);
+}
+
+//------------------------------------------------------------------------------
+bool PromptFilter::resume(StrBase& out, bool wait)
+{
+    TRACE_SCOPE("Lua: clink._resume_prompt");
+
+    if (!_pending)
+        return false;
+
+    lua_State* state = _lua.get_state();
+
+    lua_getglobal(state, "clink");
+    lua_pushliteral(state, "_resume_prompt");
+    lua_rawget(state, -2);
+
+    lua_pushboolean(state, wait);
+
+    int32 result = call(1, out);
+    if (result == call_pending)
+        return false;
+
+    _pending = false;
+    if (result == call_failed)
+    {
+        out = _unfiltered.c_str();
+        return true;
+    }
+
+    _cache.set(_cwd.c_str(), out.c_str());
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool PromptFilter::is_pending() const
+{
+    return _pending;
+}
+
+//------------------------------------------------------------------------------
+int32 PromptFilter::call(int32 arg_count, StrBase& out)
+{
+    lua_State* state = _lua.get_state();
+
+    if (lua_pcall(state, arg_count, 1, 0) != 0)
     {
         puts(lua_tostring(state, -1));
         lua_pop(state, 2);
-        return;
+        return call_failed;
+    }
+
+    // Nil is returned while the filters are still running.
+    if (lua_isnil(state, -1))
+    {
+        lua_pop(state, 2);
+        return call_pending;
     }
 
     // Collect the filtered prompt.
     const char* prompt = lua_tostring(state, -1);
+    if (prompt == nullptr)
+    {
+        lua_pop(state, 2);
+        return call_failed;
+    }
+
     out = prompt;
 
     lua_pop(state, 2);
+    return call_done;
 }
 
 
@@ -3,8 +3,9 @@
 
 #pragma once
 
+#include <core/str.h>
+
 class LuaState;
-class StrBase;
 
 //------------------------------------------------------------------------------
 class Prompt
@@ -37,15 +38,66 @@ private:
     int32           is_tagged(const wchar_t* chars, int32 char_count=0);
 };
 
+//------------------------------------------------------------------------------
+// Remembers the last few filtered prompts by the directory they were shown in,
+// and values that prompt filters have computed; see clink.promptcache(). The
+// latter go stale after a time or when files they depend on change, which is
+// tracked with a stamp combined from the files' os::get_file_stamp().
+class PromptCache
+{
+public:
+    struct Fragment
+    {
+        Str<64>     key;
+        Str<64>     value;
+        double      number = 0;
+        uint64      stamp;
+        uint32      time;
+        uint32      tick = 0;
+        int32       type;
+    };
+
+    const char*     get(const char* cwd) const;
+    void            set(const char* cwd, const char* prompt);
+    const Fragment* get_fragment(const char* key, uint64 stamp, uint32 ttl_ms);
+    void            set_fragment(const char* key, uint64 stamp, int32 type, const char* value, double number=0);
+
+private:
+    struct Entry
+    {
+        Str<288>    key;
+        Str<256>    prompt;
+        uint32      tick = 0;
+    };
+
+    Entry           _entries[8];
+    Fragment        _fragments[32];
+    uint32          _tick = 0;
+};
+
 //------------------------------------------------------------------------------
 class PromptFilter
 {
 public:
-                    PromptFilter(LuaState& lua);
+                    PromptFilter(LuaState& lua, PromptCache& cache);
     void            filter(const char* in, StrBase& out);
+    bool            resume(StrBase& out, bool wait=false);
+    bool            is_pending() const;
 
 private:
+    enum : int32
+    {
+        call_failed,
+        call_pending,
+        call_done,
+    };
+
+    int32           call(int32 arg_count, StrBase& out);
     LuaState&       _lua;
+    PromptCache&    _cache;
+    Str<288>        _cwd;
+    Str<256>        _unfiltered;
+    bool            _pending = false;
 };
 
 //------------------------------------------------------------------------------
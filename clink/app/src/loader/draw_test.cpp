@@ -284,31 +284,37 @@ void Runner::ecma48_test()
 
     // Clear screen after
     output.write(CSI(41m) CSI(3;3H) "X" CSI(J), -1);
+    output.flush();
     if (!step())
         return;
 
     // Clear screen before
     output.write(CSI(42m) CSI(5;3H) "X\b\b" CSI(1J), -1);
+    output.flush();
     if (!step())
         return;
 
     // Clear screen all
     output.write(CSI(43m) CSI(2J), -1);
+    output.flush();
     if (!step())
         return;
 
     // Clear line after
     output.write(CSI(44m) CSI(4;4H) "X" CSI(K), -1);
+    output.flush();
     if (!step())
         return;
 
     // Clear line before
     output.write(CSI(45m) CSI(5;4H) "X\b\b" CSI(1K), -1);
+    output.flush();
     if (!step())
         return;
 
     // All line
     output.write("\n" CSI(46m) CSI(2K), -1);
+    output.flush();
     if (!step())
         return;
 
@@ -9,9 +9,72 @@
 #include <core/os.h>
 #include <core/path.h>
 
+#include <getopt.h>
+
+//------------------------------------------------------------------------------
+void puts_help(const char**, int32);
+
+//------------------------------------------------------------------------------
+static void print_help()
+{
+    extern const char* g_clink_header;
+
+    const char* help[] = {
+        "-t, --trace",  "Print the last line's timings as Chrome trace JSON.",
+        "-h, --help",   "Shows this help text.",
+    };
+
+    puts(g_clink_header);
+    puts("Usage: info [options]\n");
+
+    puts_help(help, sizeof_array(help));
+
+    puts("Timings are only recorded by debug and release builds, and are only saved\n"
+        "when the 'log.trace' setting is enabled. Save the trace to a file and load\n"
+        "it into chrome://tracing to see where time was spent.\n");
+}
+
+//------------------------------------------------------------------------------
+static int32 print_trace()
+{
+    Str<280> trace_file;
+    AppContext::get()->get_trace_path(trace_file);
+
+    FILE* in = fopen(trace_file.c_str(), "rb");
+    if (in == nullptr)
+    {
+        printf("ERROR: No trace found at '%s'.\n", trace_file.c_str());
+        return 1;
+    }
+
+    char buffer[4096];
+    while (size_t read = fread(buffer, 1, sizeof(buffer), in))
+        fwrite(buffer, 1, read, stdout);
+
+    fclose(in);
+    return 0;
+}
+
 //------------------------------------------------------------------------------
 int32 clink_info(int32 argc, char** argv)
 {
+    struct option options[] = {
+        { "trace", no_argument, nullptr, 't' },
+        { "help",  no_argument, nullptr, 'h' },
+        {}
+    };
+
+    int32 i;
+    while ((i = getopt_long(argc, argv, "+th", options, nullptr)) != -1)
+    {
+        switch (i)
+        {
+        case 't': return print_trace();
+        default:
+        case 'h': print_help(); return 0;
+        }
+    }
+
     struct {
         const char* name;
         void        (AppContext::*method)(StrBase&) const;
@@ -21,6 +84,7 @@ int32 clink_info(int32 argc, char** argv)
         { "log",        &AppContext::get_log_path },
         { "settings",   &AppContext::get_settings_path },
         { "history",    &AppContext::get_history_path },
+        { "trace",      &AppContext::get_trace_path },
     };
 
     const auto* context = AppContext::get();
@@ -70,5 +134,19 @@ int32 clink_info(int32 argc, char** argv)
         }
     }
 
+    // Timings of the Lua scripts that have run.
+    Str<280> stats_file;
+    context->get_script_stats_path(stats_file);
+    if (FILE* in = fopen(stats_file.c_str(), "rt"))
+    {
+        printf("%-*s :\n", spacing, "scripts");
+
+        char line[512];
+        while (fgets(line, sizeof_array(line), in))
+            printf("%-*s     %s", spacing, "", line);
+
+        fclose(in);
+    }
+
     return 0;
 }
@@ -149,6 +149,20 @@ void AppContext::get_history_path(StrBase& out) const
     path::append(out, "clink_history");
 }
 
+//------------------------------------------------------------------------------
+void AppContext::get_trace_path(StrBase& out) const
+{
+    get_state_dir(out);
+    path::append(out, "clink_trace.json");
+}
+
+//------------------------------------------------------------------------------
+void AppContext::get_script_stats_path(StrBase& out) const
+{
+    get_state_dir(out);
+    path::append(out, "clink_script_stats");
+}
+
 //-----------------------------------------------------------------------------
 void AppContext::update_env() const
 {
@@ -30,6 +30,8 @@ public:
     void        get_log_path(StrBase& out) const;
     void        get_settings_path(StrBase& out) const;
     void        get_history_path(StrBase& out) const;
+    void        get_trace_path(StrBase& out) const;
+    void        get_script_stats_path(StrBase& out) const;
     void        update_env() const;
 
 private:
@@ -131,3 +131,8 @@ void ScrollerModule::on_input(
 void ScrollerModule::on_terminal_resize(int32 columns, int32 rows, const Context& context)
 {
 }
+
+//------------------------------------------------------------------------------
+void ScrollerModule::on_prompt_changed(const Context& context)
+{
+}
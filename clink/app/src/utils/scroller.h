@@ -31,6 +31,7 @@ private:
     virtual void    on_matches_changed(const Context& context) override;
     virtual void    on_input(const Input& Input, Result& result, const Context& context) override;
     virtual void    on_terminal_resize(int32 columns, int32 rows, const Context& context) override;
+    virtual void    on_prompt_changed(const Context& context) override;
     Scroller        _scroller;
     int32           _bind_group;
     int32           _prev_group;
@@ -0,0 +1,234 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "fs_fixture.h"
+
+#include <core/os.h>
+#include <core/str.h>
+#include <host/prompt.h>
+#include <lua/lua_state.h>
+#include <lua/script_stats.h>
+
+extern "C" {
+#include <lua.h>
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Prompt filter")
+{
+    Str<288> cwd;
+    os::get_current_dir(cwd);
+
+    PromptCache cache;
+    LuaState lua;
+    PromptFilter filter(lua, cache);
+
+    // The filter yields 'yields' times before it returns.
+    REQUIRE(lua.do_string(
+        "yields = 0\n"
+        "local f = clink.promptfilter()\n"
+        "f._name = 'prompt_test_filter'\n"
+        "function f:filter(prompt)\n"
+        "    for i = 1, yields do coroutine.yield() end\n"
+        "    return prompt .. '!'\n"
+        "end\n"));
+
+    Str<64> out;
+
+    SECTION("Synchronous")
+    {
+        filter.filter("a>", out);
+        REQUIRE(out.equals("a>!"));
+        REQUIRE(!filter.is_pending());
+        REQUIRE(!filter.resume(out));
+
+        const char* cached = cache.get(cwd.c_str());
+        REQUIRE(cached != nullptr);
+        REQUIRE(strcmp(cached, "a>!") == 0);
+    }
+
+    SECTION("Stale")
+    {
+        filter.filter("a>", out);
+
+        REQUIRE(lua.do_string("yields = 2"));
+        filter.filter("b>", out);
+        REQUIRE(out.equals("a>!"));
+        REQUIRE(filter.is_pending());
+
+        REQUIRE(!filter.resume(out));
+        REQUIRE(out.equals("a>!"));
+
+        REQUIRE(filter.resume(out));
+        REQUIRE(out.equals("b>!"));
+        REQUIRE(!filter.is_pending());
+        REQUIRE(strcmp(cache.get(cwd.c_str()), "b>!") == 0);
+    }
+
+    SECTION("Uncached")
+    {
+        // With nothing to show meanwhile the filters are waited on.
+        REQUIRE(lua.do_string("yields = 3"));
+        filter.filter("c>", out);
+        REQUIRE(out.equals("c>!"));
+        REQUIRE(!filter.is_pending());
+    }
+
+    SECTION("Error")
+    {
+        filter.filter("a>", out);
+
+        // Failures show the prompt unfiltered and don't touch the cache.
+        REQUIRE(lua.do_string("clink._filter_prompt = function() error('x') end"));
+        filter.filter("b>", out);
+        REQUIRE(out.equals("b>"));
+        REQUIRE(!filter.is_pending());
+        REQUIRE(strcmp(cache.get(cwd.c_str()), "a>!") == 0);
+    }
+
+    SECTION("Resume error")
+    {
+        filter.filter("a>", out);
+
+        REQUIRE(lua.do_string("yields = 2"));
+        filter.filter("b>", out);
+        REQUIRE(out.equals("a>!"));
+        REQUIRE(filter.is_pending());
+
+        REQUIRE(lua.do_string("clink._resume_prompt = function() error('x') end"));
+        REQUIRE(filter.resume(out));
+        REQUIRE(out.equals("b>"));
+        REQUIRE(!filter.is_pending());
+        REQUIRE(strcmp(cache.get(cwd.c_str()), "a>!") == 0);
+    }
+
+    SECTION("Userdata")
+    {
+        // Yielding something other than an io.popen2async() handle, even
+        // userdata that can't be indexed, is the same as yielding nothing.
+        lua_State* state = lua.get_state();
+        lua_newuserdata(state, 1);
+        lua_setglobal(state, "plain_userdata");
+
+        REQUIRE(lua.do_string(
+            "local f = clink.promptfilter(1)\n"
+            "function f:filter(prompt)\n"
+            "    coroutine.yield(plain_userdata)\n"
+            "    coroutine.yield(io.stdout)\n"
+            "end\n"));
+
+        filter.filter("a>", out);
+        REQUIRE(out.equals("a>!"));
+    }
+
+    SECTION("Skipped")
+    {
+        // Overrunning the budget enough times in a row skips the filter.
+        for (int32 i = 0; i < 3; ++i)
+            ScriptStats::get().record("prompt_test_filter", 10.0);
+
+        filter.filter("a>", out);
+        REQUIRE(out.equals("a>"));
+    }
+
+    ScriptStats::get().reset();
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Prompt cache")
+{
+    PromptCache cache;
+    REQUIRE(cache.get("c:\\") == nullptr);
+
+    cache.set("c:\\", "one");
+    cache.set("C:\\", "two");
+    REQUIRE(strcmp(cache.get("c:\\"), "two") == 0);
+
+    // The oldest entries are evicted first.
+    Str<32> cwd;
+    for (int32 i = 0; i < 8; ++i)
+    {
+        cwd.format("c:\\%d", i);
+        cache.set(cwd.c_str(), "x");
+    }
+
+    REQUIRE(cache.get("c:\\") == nullptr);
+    REQUIRE(cache.get("c:\\0") != nullptr);
+    REQUIRE(cache.get("c:\\7") != nullptr);
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Prompt fragments")
+{
+    static const char* fs[] = { "HEAD", nullptr };
+    FsFixture fixture(fs);
+
+    PromptCache cache;
+    LuaState lua;
+    PromptFilter filter(lua, cache);
+
+    static const char* script =
+        "calls = 0\n"
+        "key = 'a'\n"
+        "cached = clink.promptcache(function() return key, 'HEAD' end)\n"
+        "function get()\n"
+        "    return cached:get(function(k) calls = calls + 1 return k .. calls end)\n"
+        "end\n";
+
+    REQUIRE(lua.do_string(script));
+
+    REQUIRE(lua.do_string("assert(get() == 'a1')"));
+
+    SECTION("Hit")
+    {
+        REQUIRE(lua.do_string("assert(get() == 'a1')"));
+        REQUIRE(lua.do_string("assert(calls == 1)"));
+    }
+
+    SECTION("Key")
+    {
+        REQUIRE(lua.do_string("key = 'b' assert(get() == 'b2')"));
+        REQUIRE(lua.do_string("key = 'a' assert(get() == 'a1')"));
+    }
+
+    SECTION("File")
+    {
+        FILE* out = fopen("HEAD", "wt");
+        REQUIRE(out != nullptr);
+        fputs("ref: refs/heads/master", out);
+        fclose(out);
+
+        REQUIRE(lua.do_string("assert(get() == 'a2')"));
+        REQUIRE(lua.do_string("assert(get() == 'a2')"));
+    }
+
+    SECTION("Types")
+    {
+        REQUIRE(lua.do_string(
+            "local n = 0\n"
+            "for _, v in ipairs({ false, 123, 'x', 2^53 - 1, -1/3 }) do\n"
+            "    n = n + 1\n"
+            "    local c = clink.promptcache(function() return n end)\n"
+            "    c:get(function() return v end)\n"
+            "    local hit = c:get(function() error('miss') end)\n"
+            "    assert(hit == v)\n"
+            "    assert(tostring(hit) == tostring(v))\n"
+            "end\n"));
+    }
+
+    SECTION("New state")
+    {
+        // Values outlive the Lua state they were cached from and stay with the
+        // same cache even if others are created before it.
+        LuaState lua2;
+        PromptFilter filter2(lua2, cache);
+        REQUIRE(lua2.do_string(
+            "local c = clink.promptcache(function() return 'a', 'HEAD' end)\n"
+            "assert(c:get(function() return 'b' end) == 'b')\n"));
+
+        REQUIRE(lua2.do_string(script));
+        REQUIRE(lua2.do_string("assert(get() == 'a1')"));
+        REQUIRE(lua2.do_string("assert(calls == 0)"));
+    }
+}
@@ -48,6 +48,7 @@ public:
     T*              back()           { return empty() ? nullptr : (_ptr + _size - 1); }
     T*              push_back()      { return full() ? nullptr : (_ptr + _size++); }
     void            clear();
+    void            truncate(uint32 size);
     T const*        operator [] (uint32 index) const;
 
 protected:
@@ -82,6 +83,14 @@ void Array<T>::clear()
     _size = 0;
 }
 
+//------------------------------------------------------------------------------
+template <typename T>
+void Array<T>::truncate(uint32 size)
+{
+    for (; _size > size; --_size)
+        (_ptr + _size - 1)->~T();
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -95,3 +104,53 @@ public:
 private:
     T           _buffer[SIZE];
 };
+
+
+
+//------------------------------------------------------------------------------
+// Like FixedArray, SIZE elements are stored inline. When they run out the
+// elements are moved to the heap with memcpy, so T must be trivially copyable.
+template <typename T, uint32 SIZE>
+class GrowableArray
+    : public Array<T>
+{
+public:
+                GrowableArray() : Array<T>(_buffer, 0, SIZE) {}
+                ~GrowableArray();
+                GrowableArray(const GrowableArray&) = delete;
+    void        operator = (const GrowableArray&) = delete;
+    T*          push_back();
+
+private:
+    T           _buffer[SIZE];
+};
+
+//------------------------------------------------------------------------------
+template <typename T, uint32 SIZE>
+GrowableArray<T, SIZE>::~GrowableArray()
+{
+    if (this->_ptr != _buffer)
+        free(this->_ptr);
+}
+
+//------------------------------------------------------------------------------
+template <typename T, uint32 SIZE>
+T* GrowableArray<T, SIZE>::push_back()
+{
+    if (this->full())
+    {
+        uint32 capacity = this->_capacity * 2;
+        T* ptr = (T*)malloc(sizeof(T) * capacity);
+        if (ptr == nullptr)
+            return nullptr;
+
+        memcpy(ptr, this->_ptr, sizeof(T) * this->_size);
+        if (this->_ptr != _buffer)
+            free(this->_ptr);
+
+        this->_ptr = ptr;
+        this->_capacity = capacity;
+    }
+
+    return Array<T>::push_back();
+}
@@ -0,0 +1,27 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+//------------------------------------------------------------------------------
+// Watches a single file for writes, renames and deletions without polling it.
+// Changes are queued by the OS while nobody's looking; has_changed() collects
+// them. It errs on the side of reporting a change if anything goes wrong.
+class FileWatcher
+{
+public:
+                    FileWatcher() = default;
+                    ~FileWatcher();
+                    FileWatcher(const FileWatcher&) = delete;
+    void            operator = (const FileWatcher&) = delete;
+    bool            watch(const char* path);
+    void            close();
+    bool            is_watching() const;
+    bool            has_changed();
+
+private:
+    struct State;
+    bool            issue();
+    bool            scan() const;
+    State*          _state = nullptr;
+};
@@ -6,8 +6,11 @@
 #include "str.h"
 #include "singleton.h"
 
+#include <atomic>
+
 //------------------------------------------------------------------------------
 #define LOG(...)    Logger::info(__FUNCTION__, __LINE__, __VA_ARGS__)
+#define WARN(...)   Logger::warning(__FUNCTION__, __LINE__, __VA_ARGS__)
 #define ERR(...)    Logger::error(__FUNCTION__, __LINE__, __VA_ARGS__)
 
 //------------------------------------------------------------------------------
@@ -15,22 +18,50 @@ class Logger
     : public Singleton<Logger>
 {
 public:
+    enum Level : uint8
+    {
+        level_info,
+        level_warning,
+        level_error,
+    };
+
     virtual         ~Logger();
     static void     info(const char* function, int32 line, const char* fmt, ...);
+    static void     warning(const char* function, int32 line, const char* fmt, ...);
     static void     error(const char* function, int32 line, const char* fmt, ...);
 
 protected:
-    virtual void    emit(const char* function, int32 line, const char* fmt, va_list args) = 0;
+    virtual void    emit(Level level, const char* function, int32 line, const char* fmt, va_list args) = 0;
+
+private:
+    static void     log(Level level, const char* function, int32 line, const char* fmt, ...);
 };
 
 //------------------------------------------------------------------------------
+// Lines are formatted on the logging thread and queued without locks for a
+// thread of the logger's own to write out. It keeps the log file open and
+// moves it aside to "<log_path>.1" once it grows past 'max_size' bytes.
 class FileLogger
     : public Logger
 {
 public:
-                    FileLogger(const char* log_path);
-    virtual void    emit(const char* function, int32 line, const char* fmt, va_list args) override;
+                    FileLogger(const char* log_path, uint32 max_size=1 << 20);
+    virtual         ~FileLogger();
+    virtual void    emit(Level level, const char* function, int32 line, const char* fmt, va_list args) override;
 
 private:
+    struct Record;
+    void            run_writer_thread();
+    void            write(Record* records);
+    bool            open();
+    std::atomic<Record*> _records = {};
+    std::atomic<bool> _stopping = {};
     Str<256>        _log_path;
+    FILE*           _file = nullptr;
+    void*           _thread = nullptr;
+    void*           _wake_event = nullptr;
+    uint64          _start_time;
+    uint64          _frequency;
+    uint32          _max_size;
+    uint32          _size = 0;
 };
@@ -17,6 +17,7 @@ enum {
 
 int32   get_path_type(const char* path);
 int32   get_file_size(const char* path);
+uint64  get_file_stamp(const char* path);
 void    get_current_dir(StrBase& out);
 bool    set_current_dir(const char* dir);
 bool    make_dir(const char* dir);
@@ -8,11 +8,15 @@
 class Setting;
 
 //------------------------------------------------------------------------------
+// Generations change when values do, so anything derived from settings can be
+// cached until they move on; settings::get_generation() covers all settings
+// coming, going and changing, Setting::get_generation() just the one.
 namespace settings
 {
 
 Setting*            first();
 Setting*            find(const char* name);
+uint32              get_generation();
 bool                load(const char* file);
 bool                save(const char* file);
 
@@ -38,6 +42,7 @@ public:
     const char*     get_name() const;
     const char*     get_short_desc() const;
     const char*     get_long_desc() const;
+    uint32          get_generation() const;
     virtual bool    is_default() const = 0;
     virtual void    set() = 0;
     virtual bool    set(const char* value) = 0;
@@ -45,11 +50,13 @@ public:
 
 protected:
                     Setting(const char* name, const char* short_desc, const char* long_desc, TypeE Type);
+    void            changed();
     Str<32, false>  _name;
     Str<48, false>  _short_desc;
     Str<128>        _long_desc;
     Setting*        _prev;
     Setting*        _next;
+    uint32          _generation = 0;
     TypeE           _type;
 
     template <typename T>
@@ -113,7 +120,11 @@ template <typename T> SettingImpl<T>::SettingImpl(
 //------------------------------------------------------------------------------
 template <typename T> void SettingImpl<T>::set()
 {
+    if (_store == _default)
+        return;
+
     _store.value = T(_default);
+    changed();
 }
 
 //------------------------------------------------------------------------------
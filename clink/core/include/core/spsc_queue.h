@@ -0,0 +1,94 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <atomic>
+
+//------------------------------------------------------------------------------
+// A fixed size ring that one thread can push to while another pops from it,
+// without any locks. Each end only writes to its own index, which the other
+// end reads with acquire semantics to see the items published before it.
+template <typename T, uint32 SIZE>
+class SpscQueue
+{
+    static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+public:
+    bool                push(const T& value);
+    bool                push(const T* values, uint32 count);
+    bool                pop(T& out);
+    bool                empty() const;
+    uint32              get_count() const;
+    void                clear();
+
+private:
+    enum : uint32 { mask = SIZE - 1 };
+    alignas(64) std::atomic<uint32> _head = {}; // written by the consumer.
+    alignas(64) std::atomic<uint32> _tail = {}; // written by the producer.
+    T                   _items[SIZE];
+};
+
+//------------------------------------------------------------------------------
+template <typename T, uint32 SIZE>
+bool SpscQueue<T, SIZE>::push(const T& value)
+{
+    return push(&value, 1);
+}
+
+//------------------------------------------------------------------------------
+template <typename T, uint32 SIZE>
+bool SpscQueue<T, SIZE>::push(const T* values, uint32 count)
+{
+    // Either all of 'values' are pushed or none of them are, so the consumer
+    // never sees part of a sequence.
+    uint32 tail = _tail.load(std::memory_order_relaxed);
+    uint32 head = _head.load(std::memory_order_acquire);
+    if (count > SIZE - (tail - head))
+        return false;
+
+    for (uint32 i = 0; i < count; ++i)
+        _items[(tail + i) & mask] = values[i];
+
+    _tail.store(tail + count, std::memory_order_release);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template <typename T, uint32 SIZE>
+bool SpscQueue<T, SIZE>::pop(T& out)
+{
+    uint32 head = _head.load(std::memory_order_relaxed);
+    uint32 tail = _tail.load(std::memory_order_acquire);
+    if (head == tail)
+        return false;
+
+    out = _items[head & mask];
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template <typename T, uint32 SIZE>
+bool SpscQueue<T, SIZE>::empty() const
+{
+    return (get_count() == 0);
+}
+
+//------------------------------------------------------------------------------
+template <typename T, uint32 SIZE>
+uint32 SpscQueue<T, SIZE>::get_count() const
+{
+    // Head is read first so it can't have overtaken the tail that's read.
+    uint32 head = _head.load(std::memory_order_acquire);
+    uint32 tail = _tail.load(std::memory_order_acquire);
+    return tail - head;
+}
+
+//------------------------------------------------------------------------------
+template <typename T, uint32 SIZE>
+void SpscQueue<T, SIZE>::clear()
+{
+    // Only safe to call while nothing's pushing.
+    _head.store(_tail.load(std::memory_order_acquire), std::memory_order_release);
+}
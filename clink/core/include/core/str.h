@@ -65,16 +65,15 @@ public:
 
 protected:
     void                set_growable(bool state=true);
+    void                move_from(StrImpl& rhs, TYPE* rhs_data, uint32 rhs_size);
 
 private:
-    typedef uint16 ushort;
-
     void                free_data();
     TYPE*               _data;
-    ushort              _size : 15;
-    ushort              _growable : 1;
-    mutable ushort      _length : 15;
-    ushort              _owns_ptr : 1;
+    uint32              _size : 31;
+    uint32              _growable : 1;
+    mutable uint32      _length : 31;
+    uint32              _owns_ptr : 1;
 };
 
 //------------------------------------------------------------------------------
@@ -131,12 +130,22 @@ bool StrImpl<TYPE>::reserve(uint32 new_size)
     if (!is_growable())
         return false;
 
+    // Grow geometrically so strings built up a bit at a time aren't copied on
+    // every append.
+    new_size = max<uint32>(new_size, _size + (_size >> 1));
     new_size = (new_size + 63) & ~63;
 
-    TYPE* new_data = (TYPE*)malloc(new_size * sizeof(TYPE));
-    memcpy(new_data, c_str(), _size * sizeof(TYPE));
+    TYPE* new_data;
+    if (_owns_ptr)
+        new_data = (TYPE*)realloc(_data, new_size * sizeof(TYPE));
+    else
+    {
+        new_data = (TYPE*)malloc(new_size * sizeof(TYPE));
+        memcpy(new_data, c_str(), (length() + 1) * sizeof(TYPE));
+    }
 
-    free_data();
+    if (new_data == nullptr)
+        return false;
 
     _data = new_data;
     _size = new_size;
@@ -144,6 +153,35 @@ bool StrImpl<TYPE>::reserve(uint32 new_size)
     return true;
 }
 
+//------------------------------------------------------------------------------
+// Takes 'rhs's contents, leaving it empty and back on its own 'rhs_data' buffer.
+// Heap buffers change hands rather than being copied, unless this string isn't
+// growable and so can't take one on.
+template <typename TYPE>
+void StrImpl<TYPE>::move_from(StrImpl& rhs, TYPE* rhs_data, uint32 rhs_size)
+{
+    if (&rhs == this)
+        return;
+
+    if (!rhs._owns_ptr || !is_growable())
+    {
+        copy(rhs.c_str());
+        rhs.clear();
+        return;
+    }
+
+    free_data();
+    _data = rhs._data;
+    _size = rhs._size;
+    _length = rhs._length;
+    _owns_ptr = 1;
+
+    rhs._data = rhs_data;
+    rhs._size = rhs_size;
+    rhs._owns_ptr = 0;
+    rhs.clear();
+}
+
 //------------------------------------------------------------------------------
 template <typename TYPE>
 void StrImpl<TYPE>::free_data()
@@ -391,7 +429,8 @@ public:
     explicit    Str(const char* value) : Str()      { copy(value); }
     explicit    Str(const wchar_t* value) : Str()   { from_utf16(value); }
                 Str(const Str&) = delete;
-                Str(const Str&&) = delete;
+                Str(Str&& rhs) : Str()              { move_from(rhs, rhs._data, COUNT); }
+    Str&        operator = (Str&& rhs)              { move_from(rhs, rhs._data, COUNT); return *this; }
     using       StrBase::operator =;
 
 private:
@@ -406,7 +445,8 @@ public:
     explicit    Wstr(const wchar_t* value) : Wstr() { copy(value); }
     explicit    Wstr(const char* value) : Wstr()    { from_utf8(value); }
                 Wstr(const Wstr&) = delete;
-                Wstr(const Wstr&&) = delete;
+                Wstr(Wstr&& rhs) : Wstr()           { move_from(rhs, rhs._data, COUNT); }
+    Wstr&       operator = (Wstr&& rhs)             { move_from(rhs, rhs._data, COUNT); return *this; }
     using       WstrBase::operator =;
 
 private:
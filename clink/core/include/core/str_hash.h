@@ -29,3 +29,15 @@ inline uint32 wstr_hash(const wchar_t* in, int32 length=-1)
 {
     return str_hash_impl<wchar_t>(in, length);
 }
+
+//------------------------------------------------------------------------------
+inline uint64 str_hash64(const char* in, uint32 length, uint64 seed=0xcbf29ce484222325ull)
+{
+    // FNV-1a. Unlike str_hash() this doesn't stop at a terminator, and passing
+    // one hash as the seed of the next chains them together.
+    uint64 hash = seed;
+    for (uint32 i = 0; i < length; ++i)
+        hash = (hash ^ uint8(in[i])) * 0x100000001b3ull;
+
+    return hash;
+}
@@ -13,6 +13,8 @@ public:
     explicit        StrIterImpl(const T* s=(const T*)L"", int32 len=-1);
     explicit        StrIterImpl(const StrImpl<T>& s, int32 len=-1);
     const T*        get_pointer() const;
+    const T*        get_end() const;
+    void            advance(uint32 count);
     int32           peek();
     int32           next();
     bool            more() const;
@@ -43,6 +45,21 @@ template <typename T> const T* StrIterImpl<T>::get_pointer() const
     return _ptr;
 };
 
+//------------------------------------------------------------------------------
+// Returns null if the iterator only stops at a nul terminator.
+template <typename T> const T* StrIterImpl<T>::get_end() const
+{
+    return (_ptr <= _end) ? _end : nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Steps over 'count' units without decoding them. The caller is responsible for
+// landing on the start of a code point.
+template <typename T> void StrIterImpl<T>::advance(uint32 count)
+{
+    _ptr += count;
+}
+
 //------------------------------------------------------------------------------
 template <typename T> int32 StrIterImpl<T>::peek()
 {
@@ -22,6 +22,8 @@ public:
 
 
 //------------------------------------------------------------------------------
+// Delimiters and quotes are ASCII, so tokenising can scan code units rather than
+// decode them; the bytes of a UTF-8 sequence are never mistaken for either.
 template <typename T>
 class StrTokeniserImpl
 {
@@ -42,27 +44,32 @@ private:
 
     typedef FixedArray<Quote, 4> quotes;
 
+    void                add_delims(const char* delims);
+    void                add_stop(char c);
     int32               get_right_quote(int32 left) const;
     StrToken            next_impl(const T*& out_start, int32& out_length);
     quotes              _quotes;
     StrIterImpl<T>      _iter;
-    const char*         _delims;
+    uint32              _delim_map[4] = {};
+    uint32              _stop_map[4] = {};  // delimiters and left quotes.
+    char                _stops[16];         // ...as a list for block scans.
+    uint8               _stop_count = 0;
 };
 
 //------------------------------------------------------------------------------
 template <typename T>
 StrTokeniserImpl<T>::StrTokeniserImpl(const T* in, const char* delims)
 : _iter(in)
-, _delims(delims)
 {
+    add_delims(delims);
 }
 
 //------------------------------------------------------------------------------
 template <typename T>
 StrTokeniserImpl<T>::StrTokeniserImpl(const StrIterImpl<T>& in, const char* delims)
 : _iter(in)
-, _delims(delims)
 {
+    add_delims(delims);
 }
 
 //------------------------------------------------------------------------------
@@ -72,14 +79,49 @@ bool StrTokeniserImpl<T>::add_quote_pair(const char* pair)
     if (pair == nullptr || !pair[0])
         return false;
 
+    // Quotes are looked up in ASCII-only maps.
+    if (uint8(pair[0]) >= 0x80 || uint8(pair[1]) >= 0x80)
+        return false;
+
     Quote* q = _quotes.push_back();
     if (q == nullptr)
         return false;
 
     *q = { pair[0], (pair[1] ? pair[1] : pair[0]) };
+    add_stop(pair[0]);
     return true;
 }
 
+//------------------------------------------------------------------------------
+template <typename T>
+void StrTokeniserImpl<T>::add_delims(const char* delims)
+{
+    for (; *delims; ++delims)
+    {
+        uint32 c = uint8(*delims);
+        if (c < 0x80)
+            _delim_map[c >> 5] |= 1u << (c & 31);
+
+        add_stop(*delims);
+    }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void StrTokeniserImpl<T>::add_stop(char c)
+{
+    uint32 i = uint8(c);
+    if (i >= 0x80 || (_stop_map[i >> 5] & (1u << (i & 31))))
+        return;
+
+    _stop_map[i >> 5] |= 1u << (i & 31);
+
+    // Too many stops for a block scan to be a win just falls back to the map.
+    if (_stop_count < sizeof_array(_stops))
+        _stops[_stop_count] = c;
+    ++_stop_count;
+}
+
 //------------------------------------------------------------------------------
 typedef StrTokeniserImpl<char>      StrTokeniser;
 typedef StrTokeniserImpl<wchar_t> WstrTokeniser;
@@ -0,0 +1,40 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+//------------------------------------------------------------------------------
+// Scoped timings that are recorded into a ring per thread and can be dumped as
+// Chrome's trace event JSON (load it in chrome://tracing). Names must be string
+// literals as only the pointer is kept. Builds without CLINK_TRACE defined have
+// no tracing at all.
+#if defined(CLINK_TRACE)
+#   define TRACE_SCOPE(name)    TRACE_SCOPE_IMPL(name, __LINE__)
+#   define TRACE_SCOPE_IMPL(name, line) TRACE_SCOPE_IMPL2(name, line)
+#   define TRACE_SCOPE_IMPL2(name, line) TraceScope trace_scope_##line(name)
+#else
+#   define TRACE_SCOPE(name)
+#endif
+
+//------------------------------------------------------------------------------
+namespace trace
+{
+
+uint64  now();
+void    record(const char* name, uint64 start, uint64 end);
+void    release();  // Called by short-lived threads as they finish.
+bool    dump(const char* path);
+
+}; // namespace trace
+
+//------------------------------------------------------------------------------
+class TraceScope
+{
+public:
+                TraceScope(const char* name) : _name(name), _start(trace::now()) {}
+                ~TraceScope() { trace::record(_name, _start, trace::now()); }
+
+private:
+    const char* _name;
+    uint64      _start;
+};
@@ -0,0 +1,145 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "file_watcher.h"
+#include "path.h"
+#include "str.h"
+
+//------------------------------------------------------------------------------
+struct FileWatcher::State
+{
+    OVERLAPPED          overlapped;
+    HANDLE              dir;
+    Wstr<64>            name;
+    bool                pending;
+    align_to(4) uint8   buffer[2048];
+};
+
+
+
+//------------------------------------------------------------------------------
+FileWatcher::~FileWatcher()
+{
+    close();
+}
+
+//------------------------------------------------------------------------------
+bool FileWatcher::watch(const char* path)
+{
+    close();
+
+    Str<280> dir;
+    if (!path::get_directory(path, dir) || dir.empty())
+        dir = ".";
+
+    Wstr<280> wdir(dir.c_str());
+    DWORD share = FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE;
+    DWORD flags = FILE_FLAG_BACKUP_SEMANTICS|FILE_FLAG_OVERLAPPED;
+    HANDLE handle = CreateFileW(wdir.c_str(), FILE_LIST_DIRECTORY, share, nullptr,
+        OPEN_EXISTING, flags, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    _state = new State();
+    _state->dir = handle;
+    _state->name = path::get_name(path);
+    _state->overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+    if (_state->overlapped.hEvent == nullptr || !issue())
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void FileWatcher::close()
+{
+    if (_state == nullptr)
+        return;
+
+    // The read has to be cancelled and finished before the buffer can go.
+    if (_state->pending)
+    {
+        DWORD bytes;
+        CancelIo(_state->dir);
+        GetOverlappedResult(_state->dir, &_state->overlapped, &bytes, TRUE);
+    }
+
+    if (_state->overlapped.hEvent != nullptr)
+        CloseHandle(_state->overlapped.hEvent);
+
+    CloseHandle(_state->dir);
+    delete _state;
+    _state = nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool FileWatcher::is_watching() const
+{
+    return (_state != nullptr);
+}
+
+//------------------------------------------------------------------------------
+bool FileWatcher::has_changed()
+{
+    if (_state == nullptr)
+        return true;
+
+    // Changes made since the last read was issued are queued by the OS and
+    // complete the next read straight away, so every batch that's ready is
+    // collected rather than leaving some to be reported by a later call.
+    bool changed = false;
+    while (WaitForSingleObject(_state->overlapped.hEvent, 0) == WAIT_OBJECT_0)
+    {
+        _state->pending = false;
+        changed |= scan();
+
+        // Keep watching for the next change.
+        if (!issue())
+        {
+            close();
+            return true;
+        }
+    }
+
+    return changed;
+}
+
+//------------------------------------------------------------------------------
+bool FileWatcher::scan() const
+{
+    // No bytes means the buffer overflowed and what changed is unknown.
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(_state->dir, &_state->overlapped, &bytes, FALSE) || !bytes)
+        return true;
+
+    const uint8* cursor = _state->buffer;
+    while (true)
+    {
+        const auto* info = (const FILE_NOTIFY_INFORMATION*)cursor;
+        int32 name_length = int32(info->FileNameLength / sizeof(wchar_t));
+        if (name_length == int32(_state->name.length()) &&
+            _wcsnicmp(info->FileName, _state->name.c_str(), name_length) == 0)
+            return true;
+
+        if (!info->NextEntryOffset)
+            return false;
+
+        cursor += info->NextEntryOffset;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool FileWatcher::issue()
+{
+    ResetEvent(_state->overlapped.hEvent);
+
+    DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME|FILE_NOTIFY_CHANGE_LAST_WRITE|FILE_NOTIFY_CHANGE_SIZE;
+    _state->pending = !!ReadDirectoryChangesW(_state->dir, _state->buffer,
+        sizeof(_state->buffer), FALSE, filter, nullptr, &_state->overlapped, nullptr);
+    return _state->pending;
+}
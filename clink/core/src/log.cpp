@@ -3,9 +3,31 @@
 
 #include "pch.h"
 #include "log.h"
+#include "os.h"
+#include "settings.h"
 
 #include <stdarg.h>
 
+//------------------------------------------------------------------------------
+static SettingEnum g_log_level(
+    "log.level",
+    "Least severe messages to log",
+    "When logging is enabled, messages less severe than this aren't written to\n"
+    "the log file. Errors are always logged.",
+    "info,warning,error",
+    0);
+
+//------------------------------------------------------------------------------
+static Logger* get_logger(Logger::Level level)
+{
+    if (level < Logger::level_error && level < g_log_level.get())
+        return nullptr;
+
+    return Logger::get();
+}
+
+
+
 //------------------------------------------------------------------------------
 Logger::~Logger()
 {
@@ -14,20 +36,33 @@ Logger::~Logger()
 //------------------------------------------------------------------------------
 void Logger::info(const char* function, int32 line, const char* fmt, ...)
 {
-    Logger* instance = Logger::get();
+    Logger* instance = get_logger(level_info);
     if (instance == nullptr)
         return;
 
     va_list args;
     va_start(args, fmt);
-    instance->emit(function, line, fmt, args);
+    instance->emit(level_info, function, line, fmt, args);
+    va_end(args);
+}
+
+//------------------------------------------------------------------------------
+void Logger::warning(const char* function, int32 line, const char* fmt, ...)
+{
+    Logger* instance = get_logger(level_warning);
+    if (instance == nullptr)
+        return;
+
+    va_list args;
+    va_start(args, fmt);
+    instance->emit(level_warning, function, line, fmt, args);
     va_end(args);
 }
 
 //------------------------------------------------------------------------------
 void Logger::error(const char* function, int32 line, const char* fmt, ...)
 {
-    Logger* instance = Logger::get();
+    Logger* instance = get_logger(level_error);
     if (instance == nullptr)
         return;
 
@@ -35,41 +70,216 @@ void Logger::error(const char* function, int32 line, const char* fmt, ...)
 
     va_list args;
     va_start(args, fmt);
+    instance->emit(level_error, function, line, fmt, args);
+    va_end(args);
 
-    Logger::info(function, line, "*** ERROR ***");
-    instance->emit(function, line, fmt, args);
-    Logger::info(function, line, "(last error = %d)", last_error);
+    log(level_error, function, line, "(last error = %d)", last_error);
+}
 
+//------------------------------------------------------------------------------
+void Logger::log(Level level, const char* function, int32 line, const char* fmt, ...)
+{
+    Logger* instance = get_logger(level);
+    if (instance == nullptr)
+        return;
+
+    va_list args;
+    va_start(args, fmt);
+    instance->emit(level, function, line, fmt, args);
     va_end(args);
 }
 
 
 
 //------------------------------------------------------------------------------
-FileLogger::FileLogger(const char* log_path)
+// Each record is a single allocation with the formatted text on the end. The
+// time is kept as the raw counter value; the writer turns it into text.
+struct FileLogger::Record
+{
+    Record*             next;
+    const char*         function;
+    uint64              time;
+    uint32              thread_id;
+    int32               line;
+    Level               level;
+    char                text[1];
+};
+
+//------------------------------------------------------------------------------
+FileLogger::FileLogger(const char* log_path, uint32 max_size)
+: _max_size(max_size)
 {
     _log_path << log_path;
+
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&counter);
+    _frequency = counter.QuadPart;
+    QueryPerformanceCounter(&counter);
+    _start_time = counter.QuadPart;
+
+    if (!open())
+        return;
+
+    auto thunk = [] (void* param) -> DWORD {
+        auto* self = (FileLogger*)param;
+        self->run_writer_thread();
+        return 0;
+    };
+
+    _wake_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    _thread = CreateThread(nullptr, 0, thunk, this, 0, nullptr);
 }
 
 //------------------------------------------------------------------------------
-void FileLogger::emit(const char* function, int32 line, const char* fmt, va_list args)
+FileLogger::~FileLogger()
 {
-    FILE* file;
+    // The writer drains what's left before it finishes.
+    if (_thread != nullptr)
+    {
+        _stopping.store(true);
+        SetEvent(_wake_event);
+        WaitForSingleObject(_thread, INFINITE);
+        CloseHandle(_thread);
+    }
+
+    if (_wake_event != nullptr)
+        CloseHandle(_wake_event);
+
+    // Anything the writer didn't get to. At exit ExitProcess() has already
+    // ended the writer thread (the wait above returns at once) so what's still
+    // queued is written out here rather than lost.
+    if (Record* records = _records.exchange(nullptr, std::memory_order_acquire))
+        write(records);
+
+    if (_file != nullptr)
+        fclose(_file);
+}
 
-    file = fopen(_log_path.c_str(), "at");
-    if (file == nullptr)
+//------------------------------------------------------------------------------
+void FileLogger::emit(Level level, const char* function, int32 line, const char* fmt, va_list args)
+{
+    if (_thread == nullptr)
         return;
 
-    Str<24> func_name;
-    func_name << function;
+    // Most lines fit in the thread's own buffer and are formatted just the once.
+    threadlocal static char t_buffer[512];
+
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int32 length = vsnprintf(t_buffer, sizeof(t_buffer), fmt, args);
+    if (length < 0)
+    {
+        va_end(args_copy);
+        return;
+    }
+
+    auto* record = (Record*)malloc(sizeof(Record) + length);
+    if (record == nullptr)
+    {
+        va_end(args_copy);
+        return;
+    }
+
+    if (length < int32(sizeof(t_buffer)))
+        memcpy(record->text, t_buffer, length + 1);
+    else
+        vsnprintf(record->text, length + 1, fmt, args_copy);
+    va_end(args_copy);
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    record->function = function;
+    record->time = counter.QuadPart;
+    record->thread_id = GetCurrentThreadId();
+    record->line = line;
+    record->level = level;
+
+    // Records are pushed on to the front of a list that the writer takes all of
+    // in one go. Only a push to an empty list needs to wake the writer.
+    Record* head = _records.load(std::memory_order_relaxed);
+    do
+        record->next = head;
+    while (!_records.compare_exchange_weak(head, record, std::memory_order_release,
+        std::memory_order_relaxed));
+
+    if (head == nullptr)
+        SetEvent(_wake_event);
+}
+
+//------------------------------------------------------------------------------
+void FileLogger::run_writer_thread()
+{
+    while (true)
+    {
+        WaitForSingleObject(_wake_event, INFINITE);
+
+        // Read before taking the records so none pushed before stopping are left.
+        bool stopping = _stopping.load();
+        if (Record* records = _records.exchange(nullptr, std::memory_order_acquire))
+            write(records);
+
+        if (stopping)
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void FileLogger::write(Record* records)
+{
+    // The list is newest first.
+    Record* oldest = nullptr;
+    while (records != nullptr)
+    {
+        Record* next = records->next;
+        records->next = oldest;
+        oldest = records;
+        records = next;
+    }
 
     DWORD pid = GetCurrentProcessId();
+    while (Record* record = oldest)
+    {
+        if (_file != nullptr)
+        {
+            double seconds = double(record->time - _start_time) / double(_frequency);
+            int32 written = fprintf(_file, "%10.4f %04x %04x %c %-24.23s %4d %s\n",
+                seconds, pid, record->thread_id, "IWE"[record->level],
+                record->function, record->line, record->text);
 
-    Str<256> buffer;
-    buffer.format("%04x %-24s %4d ", pid, func_name.c_str(), line);
-    fputs(buffer.c_str(), file);
-    vfprintf(file, fmt, args);
-    fputs("\n", file);
+            _size += max(written, 0);
+        }
+
+        oldest = record->next;
+        free(record);
+
+        if (_size >= _max_size)
+        {
+            // Another process sharing the log may have it open, in which case
+            // the move fails and it's tried again after another 'max_size'.
+            Str<280> old_path;
+            old_path << _log_path << ".1";
+
+            fclose(_file);
+            os::unlink(old_path.c_str());
+            os::move(_log_path.c_str(), old_path.c_str());
+            open();
+            _size = 0;
+        }
+    }
+
+    if (_file != nullptr)
+        fflush(_file);
+}
+
+//------------------------------------------------------------------------------
+bool FileLogger::open()
+{
+    _file = fopen(_log_path.c_str(), "at");
+    if (_file == nullptr)
+        return false;
 
-    fclose(file);
+    fseek(_file, 0, SEEK_END);
+    _size = uint32(ftell(_file));
+    return true;
 }
@@ -36,6 +36,22 @@ int32 get_file_size(const char* path)
     return ret;
 }
 
+//------------------------------------------------------------------------------
+uint64 get_file_stamp(const char* path)
+{
+    // Changes when the file is written to. Zero if the file doesn't exist.
+    Wstr<280> wpath(path);
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(wpath.c_str(), GetFileExInfoStandard, &data))
+        return 0;
+
+    // The size is mixed in to catch writes within the time's resolution.
+    const FILETIME& time = data.ftLastWriteTime;
+    uint64 stamp = (uint64(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    uint64 size = (uint64(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    return stamp ^ (size * 0x9e3779b97f4a7c15ull);
+}
+
 //------------------------------------------------------------------------------
 void get_current_dir(StrBase& out)
 {
@@ -3,40 +3,97 @@
 
 #include "pch.h"
 #include "settings.h"
+#include "file_watcher.h"
+#include "os.h"
 #include "str.h"
 #include "str_tokeniser.h"
 
-//------------------------------------------------------------------------------
-static Setting* g_setting_list = nullptr;
+#include <algorithm>
+#include <vector>
 
+//------------------------------------------------------------------------------
+static Setting*     g_setting_list = nullptr;
+static uint32       g_generation = 0;
+static uint32       g_value_generation = 0;
 
+// Open addressed index of the settings by name, rebuilt when first needed after
+// a Setting is added or removed.
+static Setting**    g_index = nullptr;
+static uint32       g_index_mask = 0;
+static bool         g_index_stale = true;
 
-namespace settings
+//------------------------------------------------------------------------------
+// What was last read from a settings file, as 'key\0value\0' pairs.
+struct LoadedFile
 {
+    Str<280>            path;
+    FileWatcher         watcher;
+    uint64              stamp = 0;
+    uint32              generation = 0;
+    uint32              value_generation = 0;
+    std::vector<char>   pairs;
+};
+
+
 
 //------------------------------------------------------------------------------
-Setting* first()
+static uint32 name_hash(const char* name)
 {
-    return g_setting_list;
+    uint32 hash = 2166136261u;
+    for (; *name; ++name)
+        hash = (hash ^ uint8(tolower(uint8(*name)))) * 16777619u;
+
+    return hash;
 }
 
 //------------------------------------------------------------------------------
-Setting* find(const char* name)
+static void rebuild_index()
 {
-    Setting* next = first();
-    do
+    uint32 count = 0;
+    for (auto* iter = g_setting_list; iter != nullptr; iter = iter->next())
+        ++count;
+
+    // Keep the load at or below a half so probes stay short.
+    uint32 size = 16;
+    while (size < count * 2)
+        size <<= 1;
+
+    free(g_index);
+    g_index = (Setting**)calloc(size, sizeof(Setting*));
+    g_index_mask = size - 1;
+    g_index_stale = false;
+
+    // Where names clash the first in the list is found, as a walk would.
+    for (auto* iter = g_setting_list; iter != nullptr; iter = iter->next())
     {
-        if (stricmp(name, next->get_name()) == 0)
-            return next;
+        const char* name = iter->get_name();
+        for (uint32 i = name_hash(name);; ++i)
+        {
+            Setting*& slot = g_index[i & g_index_mask];
+            if (slot == nullptr)
+            {
+                slot = iter;
+                break;
+            }
+
+            if (stricmp(name, slot->get_name()) == 0)
+                break;
+        }
     }
-    while (next = next->next());
+}
 
-    return nullptr;
+//------------------------------------------------------------------------------
+static LoadedFile& get_loaded_file()
+{
+    static LoadedFile loaded;
+    return loaded;
 }
 
 //------------------------------------------------------------------------------
-bool load(const char* file)
+static bool parse_file(const char* file, std::vector<char>& pairs)
 {
+    pairs.clear();
+
     // Open the file.
     FILE* in = fopen(file, "rb");
     if (in == nullptr)
@@ -53,21 +110,15 @@ bool load(const char* file)
         return false;
     }
 
-    Str<4096> buffer;
-    buffer.reserve(size);
-
+    std::vector<char> buffer(size + 1);
     char* data = buffer.data();
     fread(data, size, 1, in);
     fclose(in);
     data[size] = '\0';
 
-    // Reset settings to default.
-    for (auto* iter = settings::first(); iter != nullptr; iter = iter->next())
-        iter->set();
-
     // Split at new lines.
     Str<256> line;
-    StrTokeniser lines(buffer.c_str(), "\n\r");
+    StrTokeniser lines(data, "\n\r");
     while (lines.next(line))
     {
         char* line_data = line.data();
@@ -96,11 +147,107 @@ bool load(const char* file)
         while (*value && isspace(*value))
             ++value;
 
-        // Find the Setting and set its value.
-        if (Setting* s = settings::find(line_data))
-            s->set(value);
+        pairs.insert(pairs.end(), line_data, key_end + 2);
+        pairs.insert(pairs.end(), value, value + strlen(value) + 1);
+    }
+
+    return true;
+}
+
+
+
+namespace settings
+{
+
+//------------------------------------------------------------------------------
+Setting* first()
+{
+    return g_setting_list;
+}
+
+//------------------------------------------------------------------------------
+Setting* find(const char* name)
+{
+    if (g_index_stale)
+        rebuild_index();
+
+    for (uint32 i = name_hash(name);; ++i)
+    {
+        Setting* slot = g_index[i & g_index_mask];
+        if (slot == nullptr || stricmp(name, slot->get_name()) == 0)
+            return slot;
+    }
+}
+
+//------------------------------------------------------------------------------
+uint32 get_generation()
+{
+    return g_generation;
+}
+
+//------------------------------------------------------------------------------
+bool load(const char* file)
+{
+    LoadedFile& loaded = get_loaded_file();
+
+    // The file's only read and parsed again if it has changed. While it's being
+    // watched it isn't even looked at until the watcher says it has.
+    bool reparse = false;
+    bool same_file = (loaded.stamp != 0 && loaded.path.iequals(file));
+    if (!same_file || loaded.watcher.has_changed())
+    {
+        // Watch first so a write made while the file's being read isn't missed.
+        if (!same_file)
+            loaded.watcher.watch(file);
+
+        uint64 stamp = os::get_file_stamp(file);
+        if (stamp == 0)
+        {
+            loaded.stamp = 0;
+            return false;
+        }
+
+        if (loaded.stamp != stamp || !same_file)
+        {
+            loaded.stamp = 0;
+            if (!parse_file(file, loaded.pairs))
+                return false;
+
+            loaded.path = file;
+            loaded.stamp = stamp;
+            reparse = true;
+        }
+    }
+
+    // Settings that have only come or gone since the last load just need the
+    // new ones setting. Otherwise values might differ from the file's.
+    bool reset = (reparse || loaded.value_generation != g_value_generation);
+    if (!reset && loaded.generation == g_generation)
+        return true;
+
+    // Find each Setting and set its value.
+    std::vector<Setting*> from_file;
+    for (const char* key = loaded.pairs.data(), *end = key + loaded.pairs.size(); key < end;)
+    {
+        const char* value = key + strlen(key) + 1;
+        if (Setting* s = settings::find(key))
+            if (s->set(value))
+                from_file.push_back(s);
+
+        key = value + strlen(value) + 1;
+    }
+
+    // Reset those settings that the file doesn't have to their defaults.
+    if (reset)
+    {
+        std::sort(from_file.begin(), from_file.end());
+        for (auto* iter = settings::first(); iter != nullptr; iter = iter->next())
+            if (!std::binary_search(from_file.begin(), from_file.end(), iter))
+                iter->set();
     }
 
+    loaded.generation = g_generation;
+    loaded.value_generation = g_value_generation;
     return true;
 }
 
@@ -186,6 +333,9 @@ Setting::Setting(
 
     if (_next != nullptr)
         _next->_prev = this;
+
+    g_index_stale = true;
+    ++g_generation;
 }
 
 //------------------------------------------------------------------------------
@@ -198,6 +348,9 @@ Setting::~Setting()
 
     if (_next != nullptr)
         _next->_prev = _prev;
+
+    g_index_stale = true;
+    ++g_generation;
 }
 
 //------------------------------------------------------------------------------
@@ -230,21 +383,38 @@ const char* Setting::get_long_desc() const
     return _long_desc.c_str();
 }
 
+//------------------------------------------------------------------------------
+uint32 Setting::get_generation() const
+{
+    return _generation;
+}
+
+//------------------------------------------------------------------------------
+void Setting::changed()
+{
+    ++_generation;
+    ++g_value_generation;
+    ++g_generation;
+}
+
 
 
 //------------------------------------------------------------------------------
 template <> bool SettingImpl<bool>::set(const char* value)
 {
-    if (stricmp(value, "true") == 0)  { _store.value = 1; return true; }
-    if (stricmp(value, "false") == 0) { _store.value = 0; return true; }
+    bool new_value;
+    if (stricmp(value, "true") == 0)            new_value = true;
+    else if (stricmp(value, "false") == 0)      new_value = false;
+    else if (*value >= '0' && *value <= '9')    new_value = !!atoi(value);
+    else                                        return false;
 
-    if (*value >= '0' && *value <= '9')
+    if (_store.value != new_value)
     {
-        _store.value = !!atoi(value);
-        return true;
+        _store.value = new_value;
+        changed();
     }
 
-    return false;
+    return true;
 }
 
 //------------------------------------------------------------------------------
@@ -253,14 +423,25 @@ template <> bool SettingImpl<int32>::set(const char* value)
     if ((*value < '0' || *value > '9') && *value != '-')
         return false;
 
-    _store.value = atoi(value);
+    int32 new_value = atoi(value);
+    if (_store.value != new_value)
+    {
+        _store.value = new_value;
+        changed();
+    }
+
     return true;
 }
 
 //------------------------------------------------------------------------------
 template <> bool SettingImpl<const char*>::set(const char* value)
 {
-    _store.value = value;
+    if (!_store.value.equals(value))
+    {
+        _store.value = value;
+        changed();
+    }
+
     return true;
 }
 
@@ -323,7 +504,12 @@ bool SettingEnum::set(const char* value)
 
         if (_strnicmp(option, value, option_len) == 0)
         {
-            _store.value = i;
+            if (_store.value != i)
+            {
+                _store.value = i;
+                changed();
+            }
+
             return true;
         }
 
@@ -6,6 +6,74 @@
 
 #include <new>
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#   define TOKENISER_SSE2
+#   include <emmintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   endif
+#endif
+
+//------------------------------------------------------------------------------
+static bool in_map(const uint32* map, uint32 c)
+{
+    return (c < 0x80) && (map[c >> 5] & (1u << (c & 31)));
+}
+
+//------------------------------------------------------------------------------
+// Finds the first nul or unit in 'map' at or after 'ptr'. If 'end' is not null
+// then the search stops there. 'stops' lists what's in 'map'.
+template <typename T>
+static const T* find_any(const T* ptr, const T* end, const uint32* map, const char*, uint32)
+{
+    for (; end == nullptr || ptr < end; ++ptr)
+        if (*ptr == '\0' || in_map(map, *ptr))
+            break;
+
+    return ptr;
+}
+
+#if defined(TOKENISER_SSE2)
+//------------------------------------------------------------------------------
+static const char* find_any(const char* ptr, const char* end, const uint32* map, const char* stops, uint32 count)
+{
+    if (count > 16)
+        return find_any<char>(ptr, end, map, stops, count);
+
+    // Aligned loads never straddle a page so reading either side of the string
+    // is safe. Bytes before 'ptr' are masked off.
+    uint32 misalign = uint32(uintptr_t(ptr) & 15);
+    const char* block = ptr - misalign;
+    uint32 mask = ~0u << misalign;
+    while (true)
+    {
+        __m128i data = _mm_load_si128((const __m128i*)block);
+        __m128i hits = _mm_cmpeq_epi8(data, _mm_setzero_si128());
+        for (uint32 i = 0; i < count; ++i)
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(data, _mm_set1_epi8(stops[i])));
+
+        if (uint32 bits = _mm_movemask_epi8(hits) & mask)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, bits);
+#else
+            uint32 index = __builtin_ctz(bits);
+#endif
+            const char* ret = block + index;
+            return (end != nullptr && ret > end) ? end : ret;
+        }
+
+        block += 16;
+        mask = ~0u;
+        if (end != nullptr && block >= end)
+            return end;
+    }
+}
+#endif // TOKENISER_SSE2
+
+
+
 //------------------------------------------------------------------------------
 template <>
 StrToken StrTokeniserImpl<char>::next(StrImpl<char>& out)
@@ -95,46 +163,42 @@ int32 StrTokeniserImpl<T>::get_right_quote(int32 left) const
 template <typename T>
 StrToken StrTokeniserImpl<T>::next_impl(const T*& out_start, int32& out_length)
 {
+    const T* ptr = _iter.get_pointer();
+    const T* end = _iter.get_end();
+
     // Skip initial delimiters.
     char delim = 0;
-    while (int32 c = _iter.peek())
+    for (; (end == nullptr || ptr < end) && in_map(_delim_map, *ptr); ++ptr)
+        delim = char(*ptr);
+
+    // Extract the delimited string. Runs of uninteresting units are skipped a
+    // block at a time, as are quoted runs once the closing quote's known.
+    const T* start = ptr;
+    while (true)
     {
-        const char* candidate = strchr(_delims, c);
-        if (candidate == nullptr)
+        ptr = find_any(ptr, end, _stop_map, _stops, _stop_count);
+        if ((end != nullptr && ptr >= end) || *ptr == '\0' || in_map(_delim_map, *ptr))
             break;
 
-        delim = *candidate;
-        _iter.next();
-    }
-
-    // Extract the delimited string.
-    const T* start = _iter.get_pointer();
-
-    int32 quote_close = 0;
-    while (int32 c = _iter.peek())
-    {
-        if (quote_close)
-        {
-            quote_close = (quote_close == c) ? 0 : quote_close;
-            _iter.next();
-            continue;
-        }
+        char right = char(get_right_quote(*ptr));
+        uint32 right_map[4] = {};
+        right_map[uint8(right) >> 5] = 1u << (uint8(right) & 31);
 
-        if (strchr(_delims, c))
+        ptr = find_any(ptr + 1, end, right_map, &right, 1);
+        if ((end != nullptr && ptr >= end) || *ptr == '\0')
             break;
 
-        quote_close = get_right_quote(c);
-        _iter.next();
+        ++ptr;
     }
 
-    const T* end = _iter.get_pointer();
+    _iter.advance(uint32(ptr - _iter.get_pointer()));
 
     // Empty string? Must be the end of the Input. We're done here.
-    if (start == end)
+    if (start == ptr)
         return StrToken::invalid_delim;
 
     // Set the output and return.
     out_start = start;
-    out_length = int32(end - start);
+    out_length = int32(ptr - start);
     return delim;
 }
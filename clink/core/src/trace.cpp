@@ -0,0 +1,157 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "trace.h"
+
+#include <atomic>
+
+//------------------------------------------------------------------------------
+struct TraceEvent
+{
+    const char*             name;
+    uint64                  start;
+    uint64                  end;
+};
+
+//------------------------------------------------------------------------------
+// Only the owning thread writes to a ring. It publishes each event by bumping
+// 'count' so a dump from another thread can tell which events are complete and
+// which it may have raced with the writer on. Rings are never freed so events
+// from threads that have since exited can still be dumped. Threads that come
+// and go release their ring as they finish so the next new thread reuses it.
+struct TraceRing
+{
+    enum : uint32 { size = 4096, mask = size - 1 };
+    TraceRing*              next;
+    uint32                  thread_id;
+    std::atomic<uint32>     count;
+    std::atomic<bool>       idle;
+    TraceEvent              events[size];
+};
+
+static std::atomic<TraceRing*>  g_rings;
+static threadlocal TraceRing*   t_ring;
+
+
+
+//------------------------------------------------------------------------------
+static TraceRing* get_ring()
+{
+    if (TraceRing* ring = t_ring)
+        return ring;
+
+    // A released ring is claimed before a new one's made. Its events start
+    // over as they belong to another thread.
+    for (auto* ring = g_rings.load(std::memory_order_acquire); ring != nullptr; ring = ring->next)
+    {
+        bool idle = true;
+        if (!ring->idle.load(std::memory_order_relaxed) ||
+            !ring->idle.compare_exchange_strong(idle, false, std::memory_order_acquire))
+            continue;
+
+        ring->thread_id = GetCurrentThreadId();
+        ring->count.store(0, std::memory_order_release);
+        t_ring = ring;
+        return ring;
+    }
+
+    auto* ring = (TraceRing*)calloc(1, sizeof(TraceRing));
+    if (ring == nullptr)
+        return nullptr;
+
+    ring->thread_id = GetCurrentThreadId();
+    ring->next = g_rings.load(std::memory_order_relaxed);
+    while (!g_rings.compare_exchange_weak(ring->next, ring, std::memory_order_release))
+        ;
+
+    t_ring = ring;
+    return ring;
+}
+
+//------------------------------------------------------------------------------
+static void dump_ring(FILE* out, const TraceRing& ring, double to_us, bool& first)
+{
+    uint32 count = ring.count.load(std::memory_order_acquire);
+    uint32 i = (count > TraceRing::size) ? count - TraceRing::size : 0;
+    for (; i < count; ++i)
+    {
+        TraceEvent event = ring.events[i & TraceRing::mask];
+
+        // Skip the event if the writer's lapped us and may have overwritten it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (ring.count.load(std::memory_order_relaxed) - i >= TraceRing::size)
+            continue;
+
+        fprintf(out,
+            "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            first ? "" : ",",
+            event.name,
+            GetCurrentProcessId(),
+            ring.thread_id,
+            double(event.start) * to_us,
+            double(event.end - event.start) * to_us);
+
+        first = false;
+    }
+}
+
+
+
+//------------------------------------------------------------------------------
+namespace trace
+{
+
+//------------------------------------------------------------------------------
+uint64 now()
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+//------------------------------------------------------------------------------
+void record(const char* name, uint64 start, uint64 end)
+{
+    TraceRing* ring = get_ring();
+    if (ring == nullptr)
+        return;
+
+    uint32 count = ring->count.load(std::memory_order_relaxed);
+    ring->events[count & TraceRing::mask] = { name, start, end };
+    ring->count.store(count + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+void release()
+{
+    TraceRing* ring = t_ring;
+    if (ring == nullptr)
+        return;
+
+    t_ring = nullptr;
+    ring->idle.store(true, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+bool dump(const char* path)
+{
+    FILE* out = fopen(path, "wt");
+    if (out == nullptr)
+        return false;
+
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+    double to_us = 1000000.0 / double(freq.QuadPart);
+
+    bool first = true;
+    fputs("{\"traceEvents\":[", out);
+    for (auto* ring = g_rings.load(std::memory_order_acquire); ring != nullptr; ring = ring->next)
+        dump_ring(out, *ring, to_us, first);
+    fputs("\n]}\n", out);
+
+    fclose(out);
+    return true;
+}
+
+}; // namespace trace
@@ -0,0 +1,94 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/file_watcher.h>
+#include <core/os.h>
+#include <core/path.h>
+#include <core/str.h>
+
+//------------------------------------------------------------------------------
+static void write_file(const char* path, const char* text)
+{
+    FILE* out = fopen(path, "wt");
+    REQUIRE(out != nullptr);
+    fputs(text, out);
+    fclose(out);
+}
+
+//------------------------------------------------------------------------------
+static bool wait_for_change(FileWatcher& watcher)
+{
+    // Notifications arrive asynchronously.
+    for (int32 i = 0; i < 100; ++i, Sleep(10))
+        if (watcher.has_changed())
+            return true;
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("FileWatcher")
+{
+    Str<280> file;
+    os::get_temp_dir(file);
+    path::append(file, "clink_test_watched");
+
+    Str<280> other;
+    os::get_temp_dir(other);
+    path::append(other, "clink_test_unwatched");
+
+    write_file(file.c_str(), "one");
+
+    FileWatcher watcher;
+    REQUIRE(watcher.watch(file.c_str()));
+    REQUIRE(watcher.is_watching());
+    REQUIRE(!watcher.has_changed());
+
+    SECTION("Write")
+    {
+        write_file(file.c_str(), "two");
+        REQUIRE(wait_for_change(watcher));
+        REQUIRE(!watcher.has_changed());
+    }
+
+    SECTION("Batches")
+    {
+        // Changes made after one batch has completed are queued for the next.
+        // All of them are collected at once.
+        write_file(file.c_str(), "two");
+        Sleep(50);
+        write_file(file.c_str(), "three");
+        Sleep(50);
+
+        REQUIRE(watcher.has_changed());
+        REQUIRE(!watcher.has_changed());
+    }
+
+    SECTION("Delete")
+    {
+        os::unlink(file.c_str());
+        REQUIRE(wait_for_change(watcher));
+    }
+
+    SECTION("Other file")
+    {
+        write_file(other.c_str(), "one");
+        Sleep(50);
+        REQUIRE(!watcher.has_changed());
+        REQUIRE(watcher.is_watching());
+    }
+
+    SECTION("Closed")
+    {
+        // Without a watch there's no telling, so it's assumed to have changed.
+        watcher.close();
+        REQUIRE(!watcher.is_watching());
+        REQUIRE(watcher.has_changed());
+    }
+
+    watcher.close();
+    os::unlink(file.c_str());
+    os::unlink(other.c_str());
+}
@@ -0,0 +1,116 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/log.h>
+#include <core/os.h>
+#include <core/path.h>
+#include <core/settings.h>
+#include <core/str.h>
+
+#include <thread>
+
+//------------------------------------------------------------------------------
+static int32 count_lines(const char* path, const char* needle)
+{
+    FILE* in = fopen(path, "rt");
+    if (in == nullptr)
+        return -1;
+
+    int32 count = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), in))
+        count += (strstr(line, needle) != nullptr);
+
+    fclose(in);
+    return count;
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("FileLogger")
+{
+    Str<280> log_file;
+    os::get_temp_dir(log_file);
+    path::append(log_file, "clink_test.log");
+
+    Str<280> old_file;
+    old_file << log_file << ".1";
+
+    os::unlink(log_file.c_str());
+    os::unlink(old_file.c_str());
+
+    SECTION("Threads")
+    {
+        {
+            FileLogger logger(log_file.c_str());
+
+            std::thread threads[4];
+            for (int32 i = 0; i < sizeof_array(threads); ++i)
+                threads[i] = std::thread([i] () {
+                    for (int32 j = 0; j < 256; ++j)
+                        LOG("test %d %d", i, j);
+                });
+
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        REQUIRE(count_lines(log_file.c_str(), " test ") == 1024);
+
+        // Each thread's lines are written in the order they were logged.
+        FILE* in = fopen(log_file.c_str(), "rt");
+        REQUIRE(in != nullptr);
+
+        int32 next[4] = {};
+        char line[256];
+        while (fgets(line, sizeof(line), in))
+        {
+            int32 i, j;
+            const char* message = strstr(line, " test ");
+            REQUIRE(message != nullptr);
+            REQUIRE(sscanf(message, " test %d %d", &i, &j) == 2);
+            REQUIRE(next[i] == j);
+            ++next[i];
+        }
+
+        fclose(in);
+    }
+
+    SECTION("Levels")
+    {
+        Setting* level = settings::find("log.level");
+        REQUIRE(level != nullptr);
+        REQUIRE(level->set("error"));
+
+        {
+            FileLogger logger(log_file.c_str());
+            LOG("test info");
+            WARN("test warning");
+            ERR("test error");
+        }
+
+        level->set();
+
+        REQUIRE(count_lines(log_file.c_str(), " test info") == 0);
+        REQUIRE(count_lines(log_file.c_str(), " test warning") == 0);
+        REQUIRE(count_lines(log_file.c_str(), " test error") == 1);
+        REQUIRE(count_lines(log_file.c_str(), "(last error = ") == 1);
+    }
+
+    SECTION("Rotation")
+    {
+        {
+            FileLogger logger(log_file.c_str(), 4096);
+            for (int32 i = 0; i < 1000; ++i)
+                LOG("test %d", i);
+        }
+
+        REQUIRE(os::get_path_type(old_file.c_str()) == os::path_type_file);
+        REQUIRE(os::get_file_size(log_file.c_str()) < 4096);
+        REQUIRE(count_lines(log_file.c_str(), " test 999") == 1);
+    }
+
+    os::unlink(log_file.c_str());
+    os::unlink(old_file.c_str());
+}
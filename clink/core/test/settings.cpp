@@ -4,7 +4,10 @@
 #include "pch.h"
 
 #include <core/base.h>
+#include <core/os.h>
+#include <core/path.h>
 #include <core/settings.h>
+#include <core/str.h>
 
 //------------------------------------------------------------------------------
 TEST_CASE("settings : basic")
@@ -149,3 +152,98 @@ TEST_CASE("settings : enum")
     REQUIRE(!test.set("abc"));  REQUIRE(test.get() == 2);
     REQUIRE(!test.set("0abc")); REQUIRE(test.get() == 2);
 }
+
+//------------------------------------------------------------------------------
+TEST_CASE("settings : generation")
+{
+    SettingInt test("!gen", "", "", 1);
+    REQUIRE(settings::find("!GEN") == &test);
+
+    // Only changes of value move the generation on.
+    uint32 generation = settings::get_generation();
+    REQUIRE(test.set("1"));
+    REQUIRE(settings::get_generation() == generation);
+
+    REQUIRE(test.set("2"));
+    REQUIRE(settings::get_generation() != generation);
+
+    generation = settings::get_generation();
+    uint32 test_generation = test.get_generation();
+    test.set();
+    REQUIRE(test.get() == 1);
+    REQUIRE(settings::get_generation() != generation);
+    REQUIRE(test.get_generation() != test_generation);
+
+    // As do settings coming and going.
+    generation = settings::get_generation();
+    {
+        SettingBool other("!gen_other", "", "", false);
+        REQUIRE(settings::get_generation() != generation);
+        REQUIRE(settings::find("!gen_other") == &other);
+
+        test_generation = test.get_generation();
+        REQUIRE(other.set("true"));
+        REQUIRE(test.get_generation() == test_generation);
+    }
+    REQUIRE(settings::find("!gen_other") == nullptr);
+    REQUIRE(settings::find("!gen") == &test);
+}
+
+//------------------------------------------------------------------------------
+static void write_file(const char* path, const char* text)
+{
+    FILE* out = fopen(path, "wt");
+    REQUIRE(out != nullptr);
+    fputs(text, out);
+    fclose(out);
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("settings : load")
+{
+    Str<280> file;
+    os::get_temp_dir(file);
+    path::append(file, "clink_test_settings");
+
+    SettingInt test("!load", "", "", 1);
+    SettingInt other("!load_other", "", "", 1);
+
+    write_file(file.c_str(), "!load = 2\n!load_new = 3\n");
+    REQUIRE(settings::load(file.c_str()));
+    REQUIRE(test.get() == 2);
+    REQUIRE(other.get() == 1);
+
+    SECTION("Re-apply")
+    {
+        // Values changed since the last load are put back to the file's, even
+        // though the file itself hasn't changed.
+        REQUIRE(test.set("5"));
+        REQUIRE(other.set("5"));
+        REQUIRE(settings::load(file.c_str()));
+        REQUIRE(test.get() == 2);
+        REQUIRE(other.get() == 1);
+    }
+
+    SECTION("New setting")
+    {
+        // Settings that come along later pick up the file's value.
+        SettingInt added("!load_new", "", "", 1);
+        REQUIRE(settings::load(file.c_str()));
+        REQUIRE(added.get() == 3);
+        REQUIRE(test.get() == 2);
+    }
+
+    SECTION("Reload")
+    {
+        // Writes to the file are noticed and it's read again.
+        write_file(file.c_str(), "!load_other = 4\n");
+
+        for (int32 i = 0; i < 100 && other.get() != 4; ++i, Sleep(10))
+            REQUIRE(settings::load(file.c_str()));
+
+        REQUIRE(other.get() == 4);
+        REQUIRE(test.get() == 1);
+    }
+
+    os::unlink(file.c_str());
+}
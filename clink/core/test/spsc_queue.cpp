@@ -0,0 +1,95 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/spsc_queue.h>
+
+#include <thread>
+
+//------------------------------------------------------------------------------
+TEST_CASE("SpscQueue: basic")
+{
+    SpscQueue<uint8, 4> queue;
+    REQUIRE(queue.empty());
+
+    uint8 value;
+    REQUIRE(!queue.pop(value));
+
+    REQUIRE(queue.push(1));
+    REQUIRE(queue.push(2));
+    REQUIRE(queue.get_count() == 2);
+
+    REQUIRE(queue.pop(value) && value == 1);
+    REQUIRE(queue.pop(value) && value == 2);
+    REQUIRE(!queue.pop(value));
+    REQUIRE(queue.empty());
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("SpscQueue: full")
+{
+    SpscQueue<uint8, 4> queue;
+
+    // Wrap the indices around the ring a few times.
+    uint8 value;
+    for (int32 i = 0; i < 10; ++i)
+    {
+        REQUIRE(queue.push(uint8(i)));
+        REQUIRE(queue.pop(value) && value == i);
+    }
+
+    const uint8 seq[] = { 1, 2, 3 };
+    REQUIRE(queue.push(seq, 3));
+    REQUIRE(!queue.push(seq, 2));
+    REQUIRE(queue.get_count() == 3);
+    REQUIRE(queue.push(4));
+    REQUIRE(!queue.push(5));
+
+    for (int32 i = 1; i <= 4; ++i)
+        REQUIRE(queue.pop(value) && value == i);
+
+    REQUIRE(queue.push(seq, 3));
+    queue.clear();
+    REQUIRE(queue.empty());
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("SpscQueue: threads")
+{
+    static const uint32 count = 1 << 16;
+    SpscQueue<uint32, 64> queue;
+
+    std::thread producer([&] () {
+        for (uint32 i = 0; i < count;)
+        {
+            uint32 pair[] = { i, ~i };
+            if (queue.push(pair, 2))
+                i += 1;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    // Values arrive in order and pairs are never split.
+    bool ok = true;
+    for (uint32 i = 0; i < count;)
+    {
+        uint32 value;
+        if (!queue.pop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        ok &= (value == i);
+        while (!queue.pop(value))
+            std::this_thread::yield();
+        ok &= (value == ~i);
+        ++i;
+    }
+
+    producer.join();
+    REQUIRE(ok);
+    REQUIRE(queue.empty());
+}
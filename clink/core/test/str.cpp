@@ -171,6 +171,40 @@ TEST_CASE("Strings" NAME_SUFFIX)
         REQUIRE(s.equals(STR("abcd1234")) == true);
     }
 
+    SECTION("Move")
+    {
+        Str<4> a;
+        a << STR("0123456789");
+        const auto* data = a.c_str();
+
+        // Heap buffers change hands.
+        Str<4> b(static_cast<Str<4>&&>(a));
+        REQUIRE(b.c_str() == data);
+        REQUIRE(b.equals(STR("0123456789")) == true);
+        REQUIRE(a.empty() == true);
+        REQUIRE(a.size() == 4);
+
+        // Inline ones are copied.
+        a << STR("123");
+        b = static_cast<Str<4>&&>(a);
+        REQUIRE(b.equals(STR("123")) == true);
+        REQUIRE(a.empty() == true);
+    }
+
+    SECTION("Long strings")
+    {
+        Str<4> s;
+        for (int32 i = 0; i < 4096; ++i)
+            s << STR("0123456789");
+
+        REQUIRE(s.length() == 40960);
+        REQUIRE(s.size() > 40960);
+        REQUIRE(s[40959] == '9');
+
+        s.truncate(32768);
+        REQUIRE(s.length() == 32768);
+    }
+
     SECTION("Construction")
     {
         char buffer[] = "Test";
@@ -99,6 +99,15 @@ TEST_CASE("StrTokeniser : quote")
     REQUIRE(t.next(s)); REQUIRE(s.equals("(-abc)") == true);
     REQUIRE(t.next(s)); REQUIRE(s.equals("'-a)b;c") == true);
     REQUIRE(!t.next(s));
+
+    // Only ASCII quotes are supported.
+    StrTokeniser u("(\xbb;\xab\xbb", ";");
+    REQUIRE(!u.add_quote_pair("(\xbb"));
+    REQUIRE(!u.add_quote_pair("\xab\xbb"));
+
+    REQUIRE(u.next(s)); REQUIRE(s.equals("(\xbb") == true);
+    REQUIRE(u.next(s)); REQUIRE(s.equals("\xab\xbb") == true);
+    REQUIRE(!u.next(s));
 }
 
 //------------------------------------------------------------------------------
@@ -113,3 +122,102 @@ TEST_CASE("StrTokeniser : delim return")
     REQUIRE(t.next(s).delim == ';'); REQUIRE(s.equals("d") == true);
     REQUIRE(!t.next(s));
 }
+
+//------------------------------------------------------------------------------
+TEST_CASE("StrTokeniser : utf8")
+{
+    // U+013B's low byte is ';' and U+00BB's lead byte isn't ASCII.
+    StrTokeniser t("\xc4\xbb;\xc2\xbb\"\xc4\xbb;\";b", ";");
+    t.add_quote_pair("\"");
+
+    Str<> s;
+    REQUIRE(t.next(s)); REQUIRE(s.equals("\xc4\xbb") == true);
+    REQUIRE(t.next(s)); REQUIRE(s.equals("\xc2\xbb\"\xc4\xbb;\"") == true);
+    REQUIRE(t.next(s)); REQUIRE(s.equals("b") == true);
+    REQUIRE(!t.next(s));
+
+    WstrTokeniser w(L"\x013b;\x00bb;b", ";");
+
+    Wstr<> ws;
+    REQUIRE(w.next(ws)); REQUIRE(ws.equals(L"\x013b") == true);
+    REQUIRE(w.next(ws)); REQUIRE(ws.equals(L"\x00bb") == true);
+    REQUIRE(w.next(ws)); REQUIRE(ws.equals(L"b") == true);
+    REQUIRE(!w.next(ws));
+}
+
+//------------------------------------------------------------------------------
+static int32 count_tokens(const char* in)
+{
+    int32 count = 0;
+    while (true)
+    {
+        while (*in == ';')
+            ++in;
+
+        if (!*in)
+            return count;
+
+        ++count;
+        for (bool quoted = false; *in && (quoted || *in != ';'); ++in)
+            quoted ^= (*in == '\'');
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("StrTokeniser : long")
+{
+    // Tokens that straddle blocks, at each alignment.
+    Str<> in;
+    for (int32 i = 0; i < 64; ++i)
+    {
+        for (int32 j = 0; j < i; ++j)
+            in << "x";
+        in << ((i & 3) ? ";" : ";'a;b';");
+    }
+
+    for (int32 offset = 0; offset < 16; ++offset)
+    {
+        StrTokeniser t(in.c_str() + offset, ";");
+        t.add_quote_pair("'");
+
+        int32 count = 0;
+        const char* start;
+        int32 length;
+        while (t.next(start, length))
+        {
+            REQUIRE(start[length] == '\0' || start[length] == ';');
+            ++count;
+        }
+
+        REQUIRE(count == count_tokens(in.c_str() + offset));
+    }
+
+    // Bounded iterators stop mid-block.
+    StrIter iter("x;xx;xxx;xxxxxxxxxxxxxxxx", 9);
+    StrTokeniser t(iter, ";");
+
+    Str<> s;
+    REQUIRE(t.next(s)); REQUIRE(s.equals("x") == true);
+    REQUIRE(t.next(s)); REQUIRE(s.equals("xx") == true);
+    REQUIRE(t.next(s)); REQUIRE(s.equals("xxx") == true);
+    REQUIRE(!t.next(s));
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("StrTokeniser : large input")
+{
+    Str<> in;
+    for (int32 i = 0; i < 4096; ++i)
+        in << "word another \"quoted words\" ;\t";
+
+    StrTokeniser t(in.c_str(), " \t;");
+    t.add_quote_pair("\"");
+
+    int32 count = 0;
+    const char* token;
+    int32 length;
+    while (t.next(token, length))
+        ++count;
+
+    REQUIRE(count == 4096 * 3);
+}
@@ -0,0 +1,90 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/os.h>
+#include <core/path.h>
+#include <core/str.h>
+#include <core/trace.h>
+
+#include <thread>
+
+//------------------------------------------------------------------------------
+static int32 count_events(const char* path, const char* name)
+{
+    FILE* in = fopen(path, "rb");
+    if (in == nullptr)
+        return -1;
+
+    Str<64> needle;
+    needle.format("{\"name\":\"%s\"", name);
+
+    int32 count = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), in))
+        count += (strstr(line, needle.c_str()) != nullptr);
+
+    fclose(in);
+    return count;
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Trace")
+{
+    Str<280> trace_file;
+    os::get_temp_dir(trace_file);
+    path::append(trace_file, "clink_test_trace.json");
+
+    SECTION("Scopes")
+    {
+        {
+            TraceScope outer("test.outer");
+            TraceScope inner("test.inner");
+        }
+
+        std::thread thread([] () { TraceScope scope("test.thread"); });
+        thread.join();
+
+        REQUIRE(trace::dump(trace_file.c_str()));
+        REQUIRE(count_events(trace_file.c_str(), "test.outer") >= 1);
+        REQUIRE(count_events(trace_file.c_str(), "test.inner") >= 1);
+        REQUIRE(count_events(trace_file.c_str(), "test.thread") >= 1);
+    }
+
+    SECTION("Wrap")
+    {
+        // Only the most recent events are kept.
+        uint64 now = trace::now();
+        for (int32 i = 0; i < 10000; ++i)
+            trace::record("test.wrap", now, now + 1);
+
+        REQUIRE(trace::dump(trace_file.c_str()));
+
+        int32 count = count_events(trace_file.c_str(), "test.wrap");
+        REQUIRE(count > 0);
+        REQUIRE(count < 10000);
+    }
+
+    SECTION("Release")
+    {
+        // A released ring is handed to the next thread, which starts it afresh.
+        std::thread first([] () {
+            { TraceScope scope("test.first"); }
+            trace::release();
+        });
+        first.join();
+
+        std::thread second([] () {
+            { TraceScope scope("test.second"); }
+            trace::release();
+        });
+        second.join();
+
+        REQUIRE(trace::dump(trace_file.c_str()));
+        REQUIRE(count_events(trace_file.c_str(), "test.first") == 0);
+        REQUIRE(count_events(trace_file.c_str(), "test.second") == 1);
+    }
+
+    os::unlink(trace_file.c_str());
+}
@@ -51,4 +51,5 @@ public:
     virtual void            on_matches_changed(const Context& context) = 0;
     virtual void            on_input(const Input& Input, Result& result, const Context& context) = 0;
     virtual void            on_terminal_resize(int32 columns, int32 rows, const Context& context) = 0;
+    virtual void            on_prompt_changed(const Context& context) = 0;
 };
@@ -0,0 +1,42 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Process-wide table of strings that are known ahead of time, such as the
+// choices of argmatchers. Each string is stored once along with its folded sort
+// key and cell count so matches can refer to it by id instead of copying it.
+class InternedStrings
+{
+public:
+    static InternedStrings& get();
+                            ~InternedStrings();
+    uint32                  intern(const char* str, uint32 length);
+    uint32                  get_count() const;
+    const char*             get_string(uint32 id) const;
+    const char*             get_sort_key(uint32 id) const;
+    uint32                  get_length(uint32 id) const;
+    uint32                  get_cell_count(uint32 id) const;
+
+private:
+    struct Entry
+    {
+        const char*         str;
+        const char*         sort_key;
+        uint32              length;
+        uint32              hash;
+        uint32              cell_count;
+    };
+
+    static const uint32     page_size = 0x10000;
+    const Entry*            get_entry(uint32 id) const;
+    char*                   alloc(uint32 size);
+    void                    rehash();
+    std::vector<Entry>      _entries;
+    std::vector<uint32>     _slots;
+    std::vector<char*>      _pages;
+    uint32                  _page_used = page_size;
+};
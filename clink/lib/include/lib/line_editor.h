@@ -34,6 +34,8 @@ public:
     virtual bool        get_line(char* out, int32 out_size) = 0;
     virtual bool        edit(char* out, int32 out_size) = 0;
     virtual bool        update() = 0;
+    virtual bool        is_pending() const = 0; // Matches are still to come.
+    virtual void        set_prompt(const char* prompt) = 0;
 };
 
 
@@ -10,10 +10,10 @@ template <typename T> class Array;
 //------------------------------------------------------------------------------
 struct Word
 {
-    uint32              offset : 14;
-    uint32              length : 10;
-    uint32              quoted : 1;
-    uint32              delim  : 7;
+    uint32              offset;
+    uint32              length;
+    uint8               quoted;
+    uint8               delim;
 };
 
 //------------------------------------------------------------------------------
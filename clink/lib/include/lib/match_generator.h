@@ -13,6 +13,12 @@ public:
     virtual bool    generate(const LineState& line, MatchBuilder& Builder) = 0;
     virtual int32   get_prefix_length(const LineState& line) const = 0;
 
+    // Generators that are still waiting on something when generate() returns
+    // report they're pending and are resumed while the editor polls for input.
+    // The return values of generate() and resume() only count once finished.
+    virtual bool    resume(const LineState& line, MatchBuilder& Builder) { return false; }
+    virtual bool    is_pending() const { return false; }
+
 private:
 };
 
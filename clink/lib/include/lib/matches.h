@@ -36,7 +36,9 @@ class MatchBuilder
 public:
                             MatchBuilder(Matches& matches);
     bool                    add_match(const char* match);
+    bool                    add_match(const char* match, uint32 length);
     bool                    add_match(const MatchDesc& desc);
+    bool                    add_interned_match(uint32 id);
     void                    set_prefix_included(bool included=true);
 
 private:
@@ -7,20 +7,20 @@
 
 #include <core/base.h>
 #include <core/str.h>
+#include <core/trace.h>
 
 #include <new>
 
 //------------------------------------------------------------------------------
-BindResolver::Binding::Binding(BindResolver* resolver, int32 node_index)
+BindResolver::Binding::Binding(BindResolver* resolver, uint32 bind_index, int32 depth)
 : _outer(resolver)
-, _node_index(node_index)
 {
     const Binder& binder = _outer->_binder;
-    const auto& Node = binder.get_node(_node_index);
+    const auto& bind = binder.get_bind(bind_index);
 
-    _module = Node.module;
-    _depth = max<uint8>(1, Node.depth);
-    _id = Node.id;
+    _module = bind.module;
+    _depth = uint8(max(1, depth));
+    _id = bind.id;
 }
 
 //------------------------------------------------------------------------------
@@ -71,19 +71,19 @@ void BindResolver::Binding::claim()
 BindResolver::BindResolver(const Binder& binder)
 : _binder(binder)
 {
+    _path[0] = _group;
 }
 
 //------------------------------------------------------------------------------
 void BindResolver::set_group(int32 group)
 {
-    if (uint32(group) - 1 >= sizeof_array(_binder._nodes) - 1)
-        return;
-
-    if (_group == group || !_binder.get_node(group - 1).is_group)
+    if (_group == group || !_binder.is_group(group))
         return;
 
     _group = group;
-    _node_index = group;
+    _path[0] = group;
+    _path_depth = 0;
+    _bind_index = ~0u;
     _pending_input = true;
 }
 
@@ -101,12 +101,14 @@ void BindResolver::reset()
     new (this) BindResolver(_binder);
 
     _group = group;
-    _node_index = _group;
+    _path[0] = _group;
 }
 
 //------------------------------------------------------------------------------
 bool BindResolver::step(uint8 key)
 {
+    TRACE_SCOPE("BindResolver::step");
+
     if (_key_count >= sizeof_array(_keys))
     {
         reset();
@@ -122,12 +124,15 @@ bool BindResolver::step(uint8 key)
 //------------------------------------------------------------------------------
 bool BindResolver::step_impl(uint8 key)
 {
-    int32 next = _binder.find_child(_node_index, key);
+    uint32 next = _binder.find_child(_path[_path_depth], key);
     if (!next)
         return true;
 
-    _node_index = next;
-    return (_binder.get_node(next).child == 0);
+    _path[++_path_depth] = next;
+    _bind_index = ~0u;
+
+    const Binder::Node& node = _binder.get_node(next);
+    return (node.child_count == 0);
 }
 
 //------------------------------------------------------------------------------
@@ -150,20 +155,24 @@ BindResolver::Binding BindResolver::next()
                 break;
     }
 
-    // Go along this depth's nodes looking for valid binds.
-    while (_node_index)
+    // Binds of the deepest node matched are offered first, then those of the
+    // nodes above it back up to the group's catch-all binds at the root.
+    while (true)
     {
-        const Binder::Node& Node = _binder.get_node(_node_index);
+        if (_bind_index == ~0u)
+            _bind_index = _binder.get_node(_path[_path_depth]).bind;
+
+        if (uint32 bind_index = _bind_index)
+        {
+            _bind_index = _binder.get_bind(bind_index).next;
+            return Binding(this, bind_index, _path_depth);
+        }
 
-        // Move iteration along to the next Node.
-        int32 node_index = _node_index;
-        _node_index = Node.next;
+        if (!_path_depth)
+            break;
 
-        // Check to see if where we're currently at a Node in the tree that is
-        // a valid bind (at the point of call).
-        int32 key_index = _tail + Node.depth - 1;
-        if (Node.bound && (!Node.key || Node.key == _keys[key_index]))
-            return Binding(this, node_index);
+        --_path_depth;
+        _bind_index = ~0u;
     }
 
     // We can't get any further traversing the tree with the Input provided.
@@ -175,6 +184,8 @@ BindResolver::Binding BindResolver::next()
 void BindResolver::claim(Binding& Binding)
 {
     _tail += Binding._depth;
-    _node_index = _group;
+    _path[0] = _group;
+    _path_depth = 0;
+    _bind_index = ~0u;
     _pending_input = true;
 }
@@ -23,10 +23,9 @@ public:
     private:
         friend class    BindResolver;
                         Binding() = default;
-                        Binding(BindResolver* resolver, int32 node_index);
+                        Binding(BindResolver* resolver, uint32 bind_index, int32 depth);
         BindResolver*   _outer = nullptr;
-        uint16          _node_index;
-        uint8           _module;
+        uint16          _module;
         uint8           _depth;
         uint8           _id;
     };
@@ -42,9 +41,11 @@ private:
     void                claim(Binding& Binding);
     bool                step_impl(uint8 key);
     const Binder&       _binder;
-    uint16              _node_index = 1;
-    uint16              _group = 1;
+    uint32              _group = 1;
+    uint32              _bind_index = ~0u;  // ~0u is the node's first bind.
+    uint32              _path[9];       // nodes stepped through, root first.
     bool                _pending_input = false;
+    uint8               _path_depth = 0;
     uint8               _tail = 0;
     uint8               _key_count = 0;
     char                _keys[8];
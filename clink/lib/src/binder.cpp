@@ -6,9 +6,7 @@
 #include "bind_resolver.h"
 
 #include <core/base.h>
-#include <core/str_hash.h>
-
-#include <algorithm>
+#include <lib/interned_strings.h>
 
 //------------------------------------------------------------------------------
 template <int32 SIZE> static bool translate_chord(const char* chord, char (&out)[SIZE])
@@ -93,12 +91,12 @@ template <int32 SIZE> static bool translate_chord(const char* chord, char (&out)
 //------------------------------------------------------------------------------
 Binder::Binder()
 {
-    // Initialise the default group.
-    _nodes[0] = { 1 };
-    _nodes[1] = { 0 };
-    _next_node = 2;
+    // Node zero is never used so that zero can mean "no node".
+    _nodes.push_back({});
+    _binds.push_back({});
 
-    static_assert(sizeof(Node) == sizeof(GroupNode), "Size assumption");
+    // Initialise the default group.
+    create_group("");
 }
 
 //------------------------------------------------------------------------------
@@ -107,17 +105,12 @@ int32 Binder::get_group(const char* name)
     if (name == nullptr || name[0] == '\0')
         return 1;
 
-    uint32 hash = str_hash(name);
+    uint32 name_id = InternedStrings::get().intern(name, uint32(strlen(name)));
 
-    int32 index = get_group_node(0)->next;
-    while (index)
-    {
-        const GroupNode* Node = get_group_node(index);
-        if (*(int32*)(Node->hash) == hash)
-            return index + 1;
-
-        index = Node->next;
-    }
+    // Most recently created groups are found first.
+    for (auto i = _groups.rbegin(), n = _groups.rend(); i != n; ++i)
+        if (i->name == name_id)
+            return i->root;
 
     return -1;
 }
@@ -125,27 +118,16 @@ int32 Binder::get_group(const char* name)
 //------------------------------------------------------------------------------
 int32 Binder::create_group(const char* name)
 {
-    if (name == nullptr || name[0] == '\0')
-        return -1;
-
-    int32 index = alloc_nodes(2);
-    if (index < 0)
+    if (name == nullptr || (name[0] == '\0' && !_groups.empty()))
         return -1;
 
-    // Create a new group Node;
-    GroupNode* group = get_group_node(index);
-    *(int32*)(group->hash) = str_hash(name);
-    group->is_group = 1;
+    uint32 root = alloc_nodes(1);
+    _nodes[root].child = alloc_table();
+    _nodes[root].has_table = 1;
 
-    // Link the new Node into the front of the list.
-    GroupNode* master = get_group_node(0);
-    group->next = master->next;
-    master->next = index;
-
-    // Next Node along is the group's root.
-    ++index;
-    _nodes[index] = {};
-    return index;
+    uint32 name_id = InternedStrings::get().intern(name, uint32(strlen(name)));
+    _groups.push_back({ name_id, root });
+    return root;
 }
 
 //------------------------------------------------------------------------------
@@ -156,7 +138,7 @@ bool Binder::bind(
     uint8 id)
 {
     // Validate Input
-    if (group >= sizeof_array(_nodes))
+    if (!is_group(group))
         return false;
 
     // Translate from ASCII representation to actual keys.
@@ -171,173 +153,171 @@ bool Binder::bind(
     if (module_index < 0)
         return false;
 
-    // Add the chord of keys into the Node graph.
-    int32 depth = 0;
-    int32 head = group;
-    for (; *chord; ++chord, ++depth)
+    // Add the chord of keys into the trie.
+    uint32 head = group;
+    for (; *chord; ++chord)
         if (!(head = insert_child(head, *chord)))
             return false;
 
-    --chord;
-
-    // If the insert point is already bound we'll duplicate the Node at the end
-    // of the list. Also check if this is a duplicate of the existing bind.
-    Node* bindee = _nodes + head;
-    if (bindee->bound)
+    // A node can have more than one bind. They're kept in the order they were
+    // bound in, and binding the same thing twice is ignored.
+    uint32* link = &(_nodes[head].bind);
+    for (; *link; link = &(_binds[*link].next))
     {
-        int32 check = head;
-        while (check > head)
-        {
-            if (bindee->key == *chord && bindee->module == module_index && bindee->id == id)
-                return true;
-
-            check = bindee->next;
-            bindee = _nodes + check;
-        }
-
-        head = append(head, *chord);
+        const Bind& bind = _binds[*link];
+        if (bind.module == module_index && bind.id == id)
+            return true;
     }
 
-    if (!head)
-        return false;
-
-    bindee = _nodes + head;
-    bindee->module = module_index;
-    bindee->bound = 1;
-    bindee->depth = depth;
-    bindee->id = id;
-
+    *link = uint32(_binds.size());
+    _binds.push_back({ 0, uint16(module_index), id });
     return true;
 }
 
 //------------------------------------------------------------------------------
-int32 Binder::insert_child(int32 parent, uint8 key)
+uint32 Binder::insert_child(uint32 parent, uint8 key)
 {
-    if (int32 child = find_child(parent, key))
+    if (uint32 child = find_child(parent, key))
         return child;
 
     return add_child(parent, key);
 }
 
 //------------------------------------------------------------------------------
-int32 Binder::find_child(int32 parent, uint8 key) const
+uint32 Binder::find_child(uint32 parent, uint8 key) const
 {
-    const Node* Node = _nodes + parent;
-
-    int32 index = Node->child;
-    for (; index > parent; index = Node->next)
+    const Node& node = _nodes[parent];
+    if (node.has_table)
+        return _tables[node.child + key];
+
+    // Children are sorted by key.
+    const Node* children = _nodes.data() + node.child;
+    uint32 lo = 0;
+    uint32 hi = node.child_count;
+    while (lo < hi)
     {
-        Node = _nodes + index;
-        if (Node->key == key)
-            return index;
+        uint32 mid = (lo + hi) >> 1;
+        uint8 mid_key = children[mid].key;
+        if (mid_key == key)
+            return node.child + mid;
+
+        if (mid_key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
 
     return 0;
 }
 
 //------------------------------------------------------------------------------
-int32 Binder::add_child(int32 parent, uint8 key)
+uint32 Binder::add_child(uint32 parent, uint8 key)
 {
-    int32 child = alloc_nodes();
-    if (child < 0)
+    uint32 depth = _nodes[parent].depth + 1;
+    if (depth > 0x7f)
         return 0;
 
     Node addee = {};
     addee.key = key;
+    addee.depth = depth;
 
-    int32 current_child = _nodes[parent].child;
-    if (current_child < parent)
+    if (_nodes[parent].has_table)
     {
-        addee.next = parent;
-        _nodes[parent].child = child;
+        // ESC and CSI (ESC [) directly below a group's root get tables too.
+        uint32 child = alloc_nodes(1);
+        if ((depth == 1 && key == 0x1b) || (depth == 2 && key == '['))
+        {
+            addee.child = alloc_table();
+            addee.has_table = 1;
+        }
+
+        _nodes[child] = addee;
+        _tables[_nodes[parent].child + key] = child;
+        ++_nodes[parent].child_count;
+        return child;
     }
-    else
+
+    // Array capacities are powers of two so the children only move when full.
+    uint32 count = _nodes[parent].child_count;
+    if ((count & (count - 1)) == 0)
     {
-        int32 tail = find_tail(current_child);
-        addee.next = parent;
-        _nodes[tail].next = child;
+        uint32 children = alloc_nodes(max<uint32>(count * 2, 1));
+        for (uint32 i = 0; i < count; ++i)
+            _nodes[children + i] = _nodes[_nodes[parent].child + i];
+
+        _nodes[parent].child = children;
     }
 
-    _nodes[child] = addee;
-    return child;
+    Node* children = _nodes.data() + _nodes[parent].child;
+    uint32 index = count;
+    for (; index > 0 && children[index - 1].key > key; --index)
+        children[index] = children[index - 1];
+
+    children[index] = addee;
+    _nodes[parent].child_count = count + 1;
+    return _nodes[parent].child + index;
 }
 
 //------------------------------------------------------------------------------
-int32 Binder::find_tail(int32 head)
+uint32 Binder::alloc_nodes(uint32 count)
 {
-    while (_nodes[head].next > head)
-        head = _nodes[head].next;
-
-    return head;
+    uint32 index = uint32(_nodes.size());
+    _nodes.resize(index + count, Node());
+    return index;
 }
 
 //------------------------------------------------------------------------------
-int32 Binder::append(int32 head, uint8 key)
+uint32 Binder::alloc_table()
 {
-    int32 index = alloc_nodes();
-    if (index < 0)
-        return 0;
-
-    int32 tail = find_tail(head);
-
-    Node addee = {};
-    addee.key = key;
-    addee.next = _nodes[tail].next;
-    _nodes[tail].next = index;
-
-    _nodes[index] = addee;
+    uint32 index = uint32(_tables.size());
+    _tables.resize(index + 256, 0);
     return index;
 }
 
 //------------------------------------------------------------------------------
-const Binder::Node& Binder::get_node(uint32 index) const
+bool Binder::is_group(uint32 index) const
 {
-    if (index < sizeof_array(_nodes))
-        return _nodes[index];
+    for (const Group& group : _groups)
+        if (group.root == index)
+            return true;
 
-    static const Node zero = {};
-    return zero;
+    return false;
 }
 
 //------------------------------------------------------------------------------
-Binder::GroupNode* Binder::get_group_node(uint32 index)
+const Binder::Node& Binder::get_node(uint32 index) const
 {
-    if (index < sizeof_array(_nodes))
-        return (GroupNode*)(_nodes + index);
+    if (index < _nodes.size())
+        return _nodes[index];
 
-    return nullptr;
+    return _nodes[0];
 }
 
 //------------------------------------------------------------------------------
-int32 Binder::alloc_nodes(uint32 count)
+const Binder::Bind& Binder::get_bind(uint32 index) const
 {
-    int32 next = _next_node + count;
-    if (next > sizeof_array(_nodes))
-        return -1;
+    if (index < _binds.size())
+        return _binds[index];
 
-    _next_node = next;
-    return _next_node - count;
+    return _binds[0];
 }
 
 //------------------------------------------------------------------------------
 int32 Binder::add_module(EditorModule& module)
 {
-    for (int32 i = 0, n = _modules.size(); i < n; ++i)
-        if (*(_modules[i]) == &module)
+    for (int32 i = 0, n = int32(_modules.size()); i < n; ++i)
+        if (_modules[i] == &module)
             return i;
 
-    if (EditorModule** slot = _modules.push_back())
-    {
-        *slot = &module;
-        return int32(slot - _modules.front());
-    }
+    if (_modules.size() > 0xffff)
+        return -1;
 
-    return -1;
+    _modules.push_back(&module);
+    return int32(_modules.size() - 1);
 }
 
 //------------------------------------------------------------------------------
 EditorModule* Binder::get_module(uint32 index) const
 {
-    auto b = _modules[index];
-    return b ? *b : nullptr;
+    return (index < _modules.size()) ? _modules[index] : nullptr;
 }
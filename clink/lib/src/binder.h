@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include <core/array.h>
+#include <vector>
 
 class EditorModule;
 
@@ -17,46 +17,46 @@ public:
     bool                bind(uint32 group, const char* chord, EditorModule& module, uint8 id);
 
 private:
-    static const int32  link_bits = 9;
-    static const int32  module_bits = 6;
-
+    // Chords are stored in a trie. A node's children are either a sorted array
+    // of nodes or, for the levels most keys pass through (a group's root and
+    // the ESC and CSI nodes below it), a table indexed directly by key.
     struct Node
     {
-        uint16          is_group    : 1;
-        uint16          next        : link_bits;
-        uint16          module      : module_bits;
-
-        uint16          child       : link_bits;
-        uint16          depth       : 4;
-        uint16          bound       : 1;
-        uint16                      : 2;
-
+        uint32          child;          // first child, or index of table.
+        uint32          bind;           // first Bind, or zero if unbound.
+        uint16          child_count;
         uint8           key;
-        uint8           id;
+        uint8           depth : 7;
+        uint8           has_table : 1;
     };
 
-    struct GroupNode
+    struct Bind
     {
-        uint16          is_group    : 1;
-        uint16          next        : link_bits;
-        uint16                      : 6;
-        uint16          hash[2];
+        uint32          next;
+        uint16          module;
+        uint8           id;
     };
 
-    typedef FixedArray<EditorModule*, (1 << module_bits)> Modules;
+    struct Group
+    {
+        uint32          name;           // id from InternedStrings.
+        uint32          root;
+    };
 
     friend class        BindResolver;
-    int32               insert_child(int32 parent, uint8 key);
-    int32               find_child(int32 parent, uint8 key) const;
-    int32               add_child(int32 parent, uint8 key);
-    int32               find_tail(int32 head);
-    int32               append(int32 head, uint8 key);
+    uint32              insert_child(uint32 parent, uint8 key);
+    uint32              find_child(uint32 parent, uint8 key) const;
+    uint32              add_child(uint32 parent, uint8 key);
+    uint32              alloc_nodes(uint32 count);
+    uint32              alloc_table();
+    bool                is_group(uint32 index) const;
     const Node&         get_node(uint32 index) const;
-    GroupNode*          get_group_node(uint32 index);
-    int32               alloc_nodes(uint32 count=1);
+    const Bind&         get_bind(uint32 index) const;
     int32               add_module(EditorModule& module);
     EditorModule*       get_module(uint32 index) const;
-    Modules             _modules;
-    Node                _nodes[1 << link_bits];
-    uint32              _next_node;
+    std::vector<EditorModule*> _modules;
+    std::vector<Node>   _nodes;
+    std::vector<Bind>   _binds;
+    std::vector<uint32> _tables;
+    std::vector<Group>  _groups;
 };
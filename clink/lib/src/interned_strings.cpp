@@ -0,0 +1,143 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "interned_strings.h"
+
+#include <core/base.h>
+#include <core/str_hash.h>
+#include <terminal/ecma48_iter.h>
+
+#include <ctype.h>
+
+//------------------------------------------------------------------------------
+InternedStrings& InternedStrings::get()
+{
+    static InternedStrings instance;
+    return instance;
+}
+
+//------------------------------------------------------------------------------
+InternedStrings::~InternedStrings()
+{
+    for (char* page : _pages)
+        free(page);
+}
+
+//------------------------------------------------------------------------------
+char* InternedStrings::alloc(uint32 size)
+{
+    // Strings never move once interned so pointers to them stay valid.
+    if (size > page_size / 4)
+    {
+        char* ptr = (char*)malloc(size);
+        _pages.insert(_pages.begin(), ptr);
+        return ptr;
+    }
+
+    if (_page_used + size > page_size)
+    {
+        _pages.push_back((char*)malloc(page_size));
+        _page_used = 0;
+    }
+
+    char* ptr = _pages.back() + _page_used;
+    _page_used += size;
+    return ptr;
+}
+
+//------------------------------------------------------------------------------
+void InternedStrings::rehash()
+{
+    uint32 slot_count = max<uint32>(uint32(_slots.size()) * 2, 256);
+    _slots.assign(slot_count, 0);
+
+    uint32 mask = slot_count - 1;
+    for (uint32 i = 0, n = uint32(_entries.size()); i < n; ++i)
+    {
+        uint32 slot = _entries[i].hash & mask;
+        while (_slots[slot])
+            slot = (slot + 1) & mask;
+
+        _slots[slot] = i + 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+uint32 InternedStrings::intern(const char* str, uint32 length)
+{
+    if (str == nullptr || !length)
+        return 0;
+
+    // Keep the table no more than half full.
+    if (_entries.size() * 2 >= _slots.size())
+        rehash();
+
+    uint32 hash = str_hash(str, length);
+    uint32 mask = uint32(_slots.size()) - 1;
+    uint32 slot = hash & mask;
+    for (; uint32 id = _slots[slot]; slot = (slot + 1) & mask)
+    {
+        const Entry& entry = _entries[id - 1];
+        if (entry.hash == hash && entry.length == length)
+            if (memcmp(entry.str, str, length) == 0)
+                return id;
+    }
+
+    // Sort keys are folded the same way stricmp() compares strings.
+    char* ptr = alloc((length + 1) * 2);
+    char* sort_key = ptr + length + 1;
+    for (uint32 i = 0; i < length; ++i)
+    {
+        ptr[i] = str[i];
+        sort_key[i] = char(tolower(uint8(str[i])));
+    }
+    ptr[length] = '\0';
+    sort_key[length] = '\0';
+
+    _entries.push_back({ ptr, sort_key, length, hash, cell_count(ptr) });
+
+    uint32 id = uint32(_entries.size());
+    _slots[slot] = id;
+    return id;
+}
+
+//------------------------------------------------------------------------------
+const InternedStrings::Entry* InternedStrings::get_entry(uint32 id) const
+{
+    return (id - 1 < _entries.size()) ? &(_entries[id - 1]) : nullptr;
+}
+
+//------------------------------------------------------------------------------
+uint32 InternedStrings::get_count() const
+{
+    return uint32(_entries.size());
+}
+
+//------------------------------------------------------------------------------
+const char* InternedStrings::get_string(uint32 id) const
+{
+    const Entry* entry = get_entry(id);
+    return entry ? entry->str : nullptr;
+}
+
+//------------------------------------------------------------------------------
+const char* InternedStrings::get_sort_key(uint32 id) const
+{
+    const Entry* entry = get_entry(id);
+    return entry ? entry->sort_key : nullptr;
+}
+
+//------------------------------------------------------------------------------
+uint32 InternedStrings::get_length(uint32 id) const
+{
+    const Entry* entry = get_entry(id);
+    return entry ? entry->length : 0;
+}
+
+//------------------------------------------------------------------------------
+uint32 InternedStrings::get_cell_count(uint32 id) const
+{
+    const Entry* entry = get_entry(id);
+    return entry ? entry->cell_count : 0;
+}
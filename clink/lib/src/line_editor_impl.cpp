@@ -10,8 +10,8 @@
 #include <core/base.h>
 #include <core/os.h>
 #include <core/path.h>
-#include <core/str_iter.h>
-#include <core/str_tokeniser.h>
+#include <core/str_hash.h>
+#include <core/trace.h>
 #include <terminal/terminal_in.h>
 #include <terminal/terminal_out.h>
 
@@ -21,6 +21,9 @@ inline char get_closing_quote(const char* quote_pair)
     return quote_pair[1] ? quote_pair[1] : quote_pair[0];
 }
 
+// How often input is polled for while generators are still running.
+static const int32 g_generate_poll_ms = 50;
+
 
 
 //------------------------------------------------------------------------------
@@ -100,8 +103,14 @@ void LineEditorImpl::begin_line()
 
     _bind_resolver.reset();
     _command_offset = 0;
+    _prefix_length = -1;
+    _lexed.clear();
+    _tokens.clear();
+    _words.clear();
     _keys_size = 0;
-    _prev_key = ~0u;
+    _generate_key = 0;
+    _select_key = 0;
+    _pending_generator = -1;
 
     MatchPipeline pipeline(_matches);
     pipeline.reset();
@@ -162,7 +171,7 @@ bool LineEditorImpl::edit(char* out, int32 out_size)
 {
     // Update first so the init state goes through.
     while (update())
-        _desc.input->select();
+        _desc.input->select(is_pending() ? g_generate_poll_ms : -1);
 
     return get_line(out, out_size);
 }
@@ -170,6 +179,8 @@ bool LineEditorImpl::edit(char* out, int32 out_size)
 //------------------------------------------------------------------------------
 bool LineEditorImpl::update()
 {
+    TRACE_SCOPE("LineEditor::update");
+
     if (!check_flag(flag_init))
         initialise();
 
@@ -177,6 +188,7 @@ bool LineEditorImpl::update()
     {
         begin_line();
         update_internal();
+        _desc.output->flush();
         return true;
     }
 
@@ -185,10 +197,40 @@ bool LineEditorImpl::update()
     if (!check_flag(flag_editing))
         return false;
 
-    update_internal();
+    // Generating matches can be slow so it's put off while there's still more
+    // input queued, such as when pasting or typing quickly.
+    if (_desc.input->has_input())
+        set_flag(flag_stale);
+    else
+        update_internal();
+
+    // Output is buffered so everything drawn for a key press goes out at once.
+    _desc.output->flush();
     return true;
 }
 
+//------------------------------------------------------------------------------
+bool LineEditorImpl::is_pending() const
+{
+    return (_pending_generator >= 0);
+}
+
+//------------------------------------------------------------------------------
+void LineEditorImpl::set_prompt(const char* prompt)
+{
+    _desc.prompt = prompt;
+    if (!check_flag(flag_editing))
+        return;
+
+    LineState line = get_linestate();
+    EditorModule::Context context = get_context(line);
+    for (auto* module : _modules)
+        module->on_prompt_changed(context);
+
+    _buffer.redraw();
+    _desc.output->flush();
+}
+
 //------------------------------------------------------------------------------
 void LineEditorImpl::update_input()
 {
@@ -252,10 +294,17 @@ void LineEditorImpl::update_input()
         uint8 id = Binding.get_id();
         Binding.get_chord(chord);
 
+        // Readline doesn't look at matches but other modules might.
+        if (module != &_module && check_flag(flag_stale))
+            update_internal();
+
         LineState line = get_linestate();
         EditorModule::Context context = get_context(line);
         EditorModule::Input input = { chord.c_str(), id };
-        module->on_input(input, result, context);
+        {
+            TRACE_SCOPE("EditorModule::on_input");
+            module->on_input(input, result, context);
+        }
 
         _bind_resolver.set_group(result.group);
 
@@ -289,65 +338,138 @@ void LineEditorImpl::update_input()
 }
 
 //------------------------------------------------------------------------------
-void LineEditorImpl::find_command_bounds(const char*& start, int32& length)
+uint32 LineEditorImpl::lex_words(uint32 start, uint8 delim)
 {
+    // Splits the line from 'start' up to the cursor into the words of the last
+    // command. Quoted parts of a word can contain delimiters. The first word
+    // is returned to the caller so it knows what changed.
     const char* line_buffer = _buffer.get_buffer();
     uint32 line_cursor = _buffer.get_cursor();
 
-    start = line_buffer;
-    length = line_cursor;
+    const char* command_delims = _desc.command_delims;
+    if (command_delims == nullptr)
+        command_delims = "";
 
-    if (_desc.command_delims == nullptr)
-        return;
+    uint32 first = _tokens.size();
+    char quote_open = _desc.quote_pair[0];
+    char quote_close = quote_open ? get_closing_quote(_desc.quote_pair) : 0;
+    for (uint32 i = start; i < line_cursor;)
+    {
+        char c = line_buffer[i];
+        if (strchr(command_delims, c))
+        {
+            do ++i; while (i < line_cursor && strchr(command_delims, line_buffer[i]));
+            _tokens.clear();
+            _command_offset = i;
+            first = delim = 0;
+            continue;
+        }
 
-    StrIter token_iter(start, length);
-    StrTokeniser tokens(token_iter, _desc.command_delims);
-    tokens.add_quote_pair(_desc.quote_pair);
-    while (tokens.next(start, length));
+        if (strchr(_desc.word_delims, c))
+        {
+            delim = c;
+            ++i;
+            continue;
+        }
 
-    // We should expect to reach the cursor. If not then there's a trailing
-    // separator and we'll just say the command starts at the cursor.
-    if (start + length != line_buffer + line_cursor)
-    {
-        start = line_buffer + line_cursor;
-        length = 0;
+        uint32 offset = i;
+        for (char close = 0; i < line_cursor; ++i)
+        {
+            c = line_buffer[i];
+            if (close)
+                close = (c == close) ? 0 : close;
+            else if (strchr(command_delims, c) || strchr(_desc.word_delims, c))
+                break;
+            else if (quote_open && c == quote_open)
+                close = quote_close;
+        }
+
+        if (Word* token = _tokens.push_back())
+            *token = { offset, i - offset, 0, delim };
+
+        delim = 0;
     }
+
+    return first;
 }
 
 //------------------------------------------------------------------------------
 void LineEditorImpl::collect_words()
 {
-    _words.clear();
+    TRACE_SCOPE("LineEditor::collect_words");
 
     const char* line_buffer = _buffer.get_buffer();
     uint32 line_cursor = _buffer.get_cursor();
 
-    const char* command_start;
-    int32 command_length;
-    find_command_bounds(command_start, command_length);
+    // Find where the line starts to differ from when words were last collected.
+    uint32 lexed_length = _lexed.length();
+    uint32 same = 0;
+    for (uint32 n = min(lexed_length, line_cursor); same < n; ++same)
+        if (line_buffer[same] != _lexed[same])
+            break;
+
+    if (same == lexed_length && same == line_cursor && !_words.empty())
+        return;
+
+    // Tokens that start before the change are still good, except for the last
+    // of them which might have grown or shrunk. Only the words after that are
+    // lexed again.
+    uint32 keep = 0;
+    for (const Word& token : _tokens)
+        if (token.offset < same)
+            ++keep;
+
+    uint32 first;
+    if (keep)
+    {
+        const Word& token = *(_tokens.front() + keep - 1);
+        uint32 start = token.offset;
+        uint8 delim = token.delim;
+        _tokens.truncate(keep - 1);
+        first = lex_words(start, delim);
+    }
+    else if (_command_offset < same)
+    {
+        _tokens.clear();
+        first = lex_words(_command_offset, 0);
+    }
+    else
+    {
+        _tokens.clear();
+        _command_offset = 0;
+        first = lex_words(0, 0);
+    }
 
-    _command_offset = int32(command_start - line_buffer);
+    _lexed.clear();
+    _lexed.concat(line_buffer, line_cursor);
 
-    StrIter token_iter(command_start, command_length);
-    StrTokeniser tokens(token_iter, _desc.word_delims);
-    tokens.add_quote_pair(_desc.quote_pair);
-    while (1)
+    // Words are tokens with quotes removed.
+    _words.truncate(first);
+    for (uint32 n = _tokens.size(); first < n; ++first)
     {
-        int32 length = 0;
-        const char* start = nullptr;
-        StrToken token = tokens.next(start, length);
-        if (!token)
+        Word* word = _words.push_back();
+        if (word == nullptr)
             break;
 
-        // Add the word.
-        uint32 offset = uint32(start - line_buffer);
-        _words.push_back();
-        *(_words.back()) = { offset, uint32(length), 0, token.delim };
+        *word = *(_tokens.front() + first);
+        if (word->length == 0)
+            continue;
+
+        const char* start = line_buffer + word->offset;
+
+        int32 start_quoted = (start[0] == _desc.quote_pair[0]);
+        int32 end_quoted = 0;
+        if (word->length > 1)
+            end_quoted = (start[word->length - 1] == get_closing_quote(_desc.quote_pair));
+
+        word->offset += start_quoted;
+        word->length -= start_quoted + end_quoted;
+        word->quoted = !!start_quoted;
     }
 
     // Add an empty word if the cursor is at the beginning of one.
-    Word* end_word = _words.back();
-    if (!end_word || end_word->offset + end_word->length < line_cursor)
+    const Word* end_token = _tokens.back();
+    if (!end_token || end_token->offset + end_token->length < line_cursor)
     {
         uint8 delim = 0;
         if (line_cursor)
@@ -357,36 +479,32 @@ void LineEditorImpl::collect_words()
         *(_words.back()) = { line_cursor, 0, 0, delim };
     }
 
-    // Adjust for quotes.
-    for (Word& word : _words)
+    // The last word is truncated to the longest length returned by the match
+    // generators. This is a little clunky but works well enough. Asking the
+    // generators can be slow so it's skipped if none of the line up to the end
+    // of the last word has changed.
+    Word* end_word = _words.back();
+    uint32 end_offset = end_word->offset + end_word->length;
+    if (_prefix_length < 0
+        || same < end_offset
+        || _prefix_word.offset != end_word->offset
+        || _prefix_word.length != end_word->length
+        || _prefix_word.quoted != end_word->quoted
+        || _prefix_word.delim != end_word->delim)
     {
-        if (word.length == 0)
-            continue;
-
-        const char* start = line_buffer + word.offset;
-
-        int32 start_quoted = (start[0] == _desc.quote_pair[0]);
-        int32 end_quoted = 0;
-        if (word.length > 1)
-            end_quoted = (start[word.length - 1] == get_closing_quote(_desc.quote_pair));
+        LineState line = get_linestate();
+        int32 prefix_length = 0;
+        for (const auto* generator : _generators)
+        {
+            int32 i = generator->get_prefix_length(line);
+            prefix_length = max(prefix_length, i);
+        }
 
-        word.offset += start_quoted;
-        word.length -= start_quoted + end_quoted;
-        word.quoted = !!start_quoted;
+        _prefix_word = *end_word;
+        _prefix_length = prefix_length;
     }
 
-    // The last word is truncated to the longest length returned by the match
-    // generators. This is a little clunky but works well enough.
-    LineState line = get_linestate();
-    end_word = _words.back();
-    int32 prefix_length = 0;
-    const char* word_start = line_buffer + end_word->offset;
-    for (const auto* generator : _generators)
-    {
-        int32 i = generator->get_prefix_length(line);
-        prefix_length = max(prefix_length, i);
-    }
-    end_word->length = min<uint32>(prefix_length, end_word->length);
+    end_word->length = min<uint32>(_prefix_length, end_word->length);
 }
 
 //------------------------------------------------------------------------------
@@ -574,48 +692,53 @@ bool LineEditorImpl::check_flag(uint8 flag) const
 //------------------------------------------------------------------------------
 void LineEditorImpl::update_internal()
 {
+    clear_flag(flag_stale);
     collect_words();
 
     const Word& end_word = *(_words.back());
 
-    union key_t {
-        struct {
-            uint32 word_offset : 11;
-            uint32 word_length : 10;
-            uint32 cursor_pos  : 11;
-        };
-        uint32 value;
-    };
+    // Matches are generated again if the end word changes, and are selected
+    // again if the text from there up to the cursor does too.
+    const char* buf_ptr = _buffer.get_buffer();
+    uint32 cursor = _buffer.get_cursor();
+    uint32 word_end = end_word.offset + end_word.length;
 
-    key_t next_key = { end_word.offset, end_word.length };
+    uint32 bounds[] = { end_word.offset, end_word.length, cursor };
+    uint64 generate_key = str_hash64((const char*)bounds, sizeof(uint32) * 2);
+    generate_key = str_hash64(buf_ptr + end_word.offset, end_word.length, generate_key);
 
-    key_t prev_key;
-    prev_key.value = _prev_key;
-    prev_key.cursor_pos = 0;
+    uint64 select_key = str_hash64((const char*)(bounds + 2), sizeof(uint32), generate_key);
+    select_key = str_hash64(buf_ptr + word_end, cursor - word_end, select_key);
 
     // Should we generate new matches?
-    if (next_key.value != prev_key.value)
+    if (generate_key != _generate_key)
     {
         LineState line = get_linestate();
         MatchPipeline pipeline(_matches);
         pipeline.reset();
-        pipeline.generate(line, _generators);
-        pipeline.fill_info();
-    }
+        _pending_generator = pipeline.generate(line, _generators);
 
-    next_key.cursor_pos = _buffer.get_cursor();
-    prev_key.value = _prev_key;
+        _generate_key = generate_key;
+    }
+    else if (_pending_generator >= 0)
+    {
+        // Generators that were waiting on something may have added more
+        // matches, in which case they're selected again.
+        LineState line = get_linestate();
+        MatchPipeline pipeline(_matches);
+        if (pipeline.resume(line, _generators, _pending_generator))
+            _select_key = 0;
+    }
 
     // Should we sort and select matches?
-    if (next_key.value != prev_key.value)
+    if (select_key != _select_key)
     {
         Str<64> needle;
         int32 needle_start = end_word.offset;
         if (!_matches.is_prefix_included())
             needle_start += end_word.length;
 
-        const char* buf_ptr = _buffer.get_buffer();
-        needle.concat(buf_ptr + needle_start, next_key.cursor_pos - needle_start);
+        needle.concat(buf_ptr + needle_start, cursor - needle_start);
 
         if (!needle.empty() && end_word.quoted)
         {
@@ -626,9 +749,10 @@ void LineEditorImpl::update_internal()
 
         MatchPipeline pipeline(_matches);
         pipeline.select(needle.c_str());
+        pipeline.fill_info();
         pipeline.sort();
 
-        _prev_key = next_key.value;
+        _select_key = select_key;
 
         // Tell all the modules that the matches changed.
         LineState line = get_linestate();
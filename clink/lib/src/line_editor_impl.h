@@ -13,6 +13,7 @@
 #include "rl/rl_buffer.h"
 
 #include <core/array.h>
+#include <core/str.h>
 #include <terminal/printer.h>
 
 //------------------------------------------------------------------------------
@@ -26,12 +27,14 @@ public:
     virtual bool        get_line(char* out, int32 out_size) override;
     virtual bool        edit(char* out, int32 out_size) override;
     virtual bool        update() override;
+    virtual bool        is_pending() const override;
+    virtual void        set_prompt(const char* prompt) override;
 
 private:
     typedef EditorModule                    Module;
     typedef FixedArray<EditorModule*, 16>   Modules;
     typedef FixedArray<MatchGenerator*, 32> Generators;
-    typedef FixedArray<Word, 72>            Words;
+    typedef GrowableArray<Word, 72>         Words;
 
     enum Flags : uint8
     {
@@ -39,12 +42,13 @@ private:
         flag_editing    = 1 << 1,
         flag_done       = 1 << 2,
         flag_eof        = 1 << 3,
+        flag_stale      = 1 << 4,
     };
 
     void                initialise();
     void                begin_line();
     void                end_line();
-    void                find_command_bounds(const char*& start, int32& length);
+    uint32              lex_words(uint32 start, uint8 delim);
     void                collect_words();
     void                update_internal();
     void                update_input();
@@ -62,11 +66,17 @@ private:
     Generators          _generators;
     Binder              _binder;
     BindResolver        _bind_resolver = { _binder };
+    Words               _tokens;
     Words               _words;
+    Str<128>            _lexed;
+    Word                _prefix_word;
+    int32               _prefix_length = -1;
     MatchesImpl         _matches;
     Printer             _printer;
-    uint32              _prev_key;
-    uint16              _command_offset;
+    uint64              _generate_key;
+    uint64              _select_key;
+    int32               _pending_generator = -1;
+    uint32              _command_offset;
     uint8               _keys_size;
     uint8               _flags = 0;
 };
@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "match_pipeline.h"
+#include "interned_strings.h"
 #include "line_state.h"
 #include "match_generator.h"
 #include "match_pipeline.h"
@@ -10,6 +11,7 @@
 
 #include <core/array.h>
 #include <core/str_compare.h>
+#include <core/trace.h>
 #include <terminal/ecma48_iter.h>
 
 #include <algorithm>
@@ -24,7 +26,7 @@ static uint32 normal_selector(
     int32 select_count = 0;
     for (int32 i = 0; i < count; ++i)
     {
-        const char* name = Store.get(infos[i].store_id);
+        const char* name = Store.get(infos[i]);
         int32 j = str_compare(needle, name);
         infos[i].select = (j < 0 || !needle[j]);
         ++select_count;
@@ -36,9 +38,18 @@ static uint32 normal_selector(
 //------------------------------------------------------------------------------
 static void alpha_sorter(const MatchStore& Store, MatchInfo* infos, int32 count)
 {
+    // Interned matches have pre-folded sort keys that can be compared as is.
+    const InternedStrings& interned = InternedStrings::get();
     auto predicate = [&] (const MatchInfo& lhs, const MatchInfo& rhs) {
-        const char* l = Store.get(lhs.store_id);
-        const char* r = Store.get(rhs.store_id);
+        if (lhs.interned_id && rhs.interned_id)
+        {
+            const char* l = interned.get_sort_key(lhs.interned_id);
+            const char* r = interned.get_sort_key(rhs.interned_id);
+            return (strcmp(l, r) < 0);
+        }
+
+        const char* l = Store.get(lhs);
+        const char* r = Store.get(rhs);
         return (stricmp(l, r) < 0);
     };
 
@@ -60,34 +71,92 @@ void MatchPipeline::reset() const
 }
 
 //------------------------------------------------------------------------------
-void MatchPipeline::generate(
+// Returns the index of a generator that's still to finish, or -1 if they all
+// have. Generators after it wait for it, as it may yet claim the line.
+int32 MatchPipeline::generate(
     const LineState& state,
     const Array<MatchGenerator*>& generators) const
+{
+    TRACE_SCOPE("MatchPipeline::generate");
+
+    return generate_from(state, generators, 0);
+}
+
+//------------------------------------------------------------------------------
+// Returns true if more matches were added, in which case they need selecting
+// again. 'pending' is updated as generate() does.
+bool MatchPipeline::resume(
+    const LineState& state,
+    const Array<MatchGenerator*>& generators,
+    int32& pending) const
+{
+    TRACE_SCOPE("MatchPipeline::resume");
+
+    uint32 count = _matches.get_info_count();
+
+    MatchGenerator* generator = *(generators[pending]);
+    MatchBuilder builder(_matches);
+    bool claimed = generator->resume(state, builder);
+    if (!generator->is_pending())
+        pending = claimed ? -1 : generate_from(state, generators, pending + 1);
+
+    return (_matches.get_info_count() != count);
+}
+
+//------------------------------------------------------------------------------
+int32 MatchPipeline::generate_from(
+    const LineState& state,
+    const Array<MatchGenerator*>& generators,
+    uint32 index) const
 {
     MatchBuilder builder(_matches);
-    for (auto* generator : generators)
-        if (generator->generate(state, builder))
+    for (uint32 n = generators.size(); index < n; ++index)
+    {
+        MatchGenerator* generator = *(generators[index]);
+        bool claimed = generator->generate(state, builder);
+        if (generator->is_pending())
+            return int32(index);
+
+        if (claimed)
             break;
+    }
+
+    return -1;
 }
 
 //------------------------------------------------------------------------------
 void MatchPipeline::fill_info() const
 {
-    int32 count = _matches.get_info_count();
+    TRACE_SCOPE("MatchPipeline::fill_info");
+
+    // Only the matches that are selected get measured, and only the once.
+    int32 count = _matches.get_match_count();
     if (!count)
         return;
 
+    const InternedStrings& interned = InternedStrings::get();
     MatchInfo* info = _matches.get_infos();
     for (int32 i = 0; i < count; ++i, ++info)
     {
-        const char* displayable = _matches.get_displayable(i);
-        info->cell_count = cell_count(displayable);
+        if (info->has_cell_count)
+            continue;
+
+        uint32 cells;
+        if (info->interned_id && !info->displayable_store_id)
+            cells = interned.get_cell_count(info->interned_id);
+        else
+            cells = cell_count(_matches.get_displayable(i));
+
+        info->cell_count = min<uint32>(cells, 0x7fff);
+        info->has_cell_count = 1;
     }
 }
 
 //------------------------------------------------------------------------------
 void MatchPipeline::select(const char* needle) const
 {
+    TRACE_SCOPE("MatchPipeline::select");
+
     int32 count = _matches.get_info_count();
     if (!count)
         return;
@@ -102,6 +171,8 @@ void MatchPipeline::select(const char* needle) const
 //------------------------------------------------------------------------------
 void MatchPipeline::sort() const
 {
+    TRACE_SCOPE("MatchPipeline::sort");
+
     int32 count = _matches.get_match_count();
     if (!count)
         return;
@@ -14,11 +14,13 @@ class MatchPipeline
 public:
                         MatchPipeline(MatchesImpl& matches);
     void                reset() const;
-    void                generate(const LineState& state, const Array<MatchGenerator*>& generators) const;
+    int32               generate(const LineState& state, const Array<MatchGenerator*>& generators) const;
+    bool                resume(const LineState& state, const Array<MatchGenerator*>& generators, int32& pending) const;
     void                fill_info() const;
     void                select(const char* needle) const;
     void                sort() const;
 
 private:
+    int32               generate_from(const LineState& state, const Array<MatchGenerator*>& generators, uint32 index) const;
     MatchesImpl&        _matches;
 };
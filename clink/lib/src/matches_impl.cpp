@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "matches_impl.h"
+#include "interned_strings.h"
 
 #include <core/base.h>
 #include <core/str.h>
@@ -21,12 +22,25 @@ bool MatchBuilder::add_match(const char* match)
     return add_match(desc);
 }
 
+//------------------------------------------------------------------------------
+bool MatchBuilder::add_match(const char* match, uint32 length)
+{
+    MatchDesc desc = { match };
+    return ((MatchesImpl&)_matches).add_match(desc, length);
+}
+
 //------------------------------------------------------------------------------
 bool MatchBuilder::add_match(const MatchDesc& desc)
 {
     return ((MatchesImpl&)_matches).add_match(desc);
 }
 
+//------------------------------------------------------------------------------
+bool MatchBuilder::add_interned_match(uint32 id)
+{
+    return ((MatchesImpl&)_matches).add_interned_match(id);
+}
+
 //------------------------------------------------------------------------------
 void MatchBuilder::set_prefix_included(bool included)
 {
@@ -42,6 +56,15 @@ const char* MatchStore::get(uint32 id) const
     return (id < _size) ? (_ptr + id) : nullptr;
 }
 
+//------------------------------------------------------------------------------
+const char* MatchStore::get(const MatchInfo& info) const
+{
+    if (info.interned_id)
+        return InternedStrings::get().get_string(info.interned_id);
+
+    return get(info.store_id);
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -67,14 +90,17 @@ void MatchesImpl::StoreImpl::reset()
 }
 
 //------------------------------------------------------------------------------
-int32 MatchesImpl::StoreImpl::store_front(const char* str)
+int32 MatchesImpl::StoreImpl::store_front(const char* str, int32 length)
 {
-    uint32 size = get_size(str);
+    if (length < 0 && str != nullptr)
+        length = int32(strlen(str));
+
+    uint32 size = get_size(str, length);
     uint32 next = _front + size;
     if (next > _back)
         return -1;
 
-    StrBase(_ptr + _front, size).copy(str);
+    copy(_front, str, length);
 
     uint32 ret = _front;
     _front = next;
@@ -82,30 +108,42 @@ int32 MatchesImpl::StoreImpl::store_front(const char* str)
 }
 
 //------------------------------------------------------------------------------
-int32 MatchesImpl::StoreImpl::store_back(const char* str)
+int32 MatchesImpl::StoreImpl::store_back(const char* str, int32 length)
 {
-    uint32 size = get_size(str);
+    if (length < 0 && str != nullptr)
+        length = int32(strlen(str));
+
+    uint32 size = get_size(str, length);
     uint32 next = _back - size;
-    if (next < _front)
+    if (next < _front || next > _back)
         return -1;
 
     _back = next;
-    StrBase(_ptr + _back, size).copy(str);
+    copy(_back, str, length);
 
     return _back >> alignment_bits;
 }
 
 //------------------------------------------------------------------------------
-uint32 MatchesImpl::StoreImpl::get_size(const char* str) const
+uint32 MatchesImpl::StoreImpl::get_size(const char* str, int32 length) const
 {
-    if (str == nullptr || str[0] == '\0')
+    if (str == nullptr || length <= 0)
         return ~0u;
 
-    int32 length = int32(strlen(str) + 1);
+    ++length;
     length = (length + alignment - 1) & ~(alignment - 1);
     return length;
 }
 
+//------------------------------------------------------------------------------
+void MatchesImpl::StoreImpl::copy(uint32 offset, const char* str, uint32 length)
+{
+    // The length is already known so there's no need to scan for a terminator
+    // again. The string is terminated here as it may be a slice of a larger one.
+    memcpy(_ptr + offset, str, length);
+    _ptr[offset + length] = '\0';
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -145,8 +183,7 @@ const char* MatchesImpl::get_match(uint32 index) const
     if (index >= get_match_count())
         return nullptr;
 
-    uint32 store_id = _infos[index].store_id;
-    return _store.get(store_id);
+    return _store.get(_infos[index]);
 }
 
 //------------------------------------------------------------------------------
@@ -155,11 +192,10 @@ const char* MatchesImpl::get_displayable(uint32 index) const
     if (index >= get_match_count())
         return nullptr;
 
-    uint32 store_id = _infos[index].displayable_store_id;
-    if (!store_id)
-        store_id = _infos[index].store_id;
+    if (uint32 store_id = _infos[index].displayable_store_id)
+        return _store.get(store_id);
 
-    return _store.get(store_id);
+    return _store.get(_infos[index]);
 }
 
 //------------------------------------------------------------------------------
@@ -250,14 +286,14 @@ void MatchesImpl::set_prefix_included(bool included)
 }
 
 //------------------------------------------------------------------------------
-bool MatchesImpl::add_match(const MatchDesc& desc)
+bool MatchesImpl::add_match(const MatchDesc& desc, int32 match_length)
 {
     const char* match = desc.match;
 
-    if (_coalesced || match == nullptr || !*match)
+    if (match == nullptr || !*match || !match_length)
         return false;
 
-    int32 store_id = _store.store_front(match);
+    int32 store_id = _store.store_front(match, match_length);
     if (store_id < 0)
         return false;
 
@@ -270,16 +306,39 @@ bool MatchesImpl::add_match(const MatchDesc& desc)
         aux_store_id = max(0, _store.store_back(desc.aux));
 
     _infos.push_back({
+        0,
         (uint16)store_id,
         (uint16)displayable_store_id,
         (uint16)aux_store_id,
         0,
+        0,
         max<uint8>(0, desc.suffix),
     });
-    ++_count;
+    add_info();
     return true;
 }
 
+//------------------------------------------------------------------------------
+bool MatchesImpl::add_interned_match(uint32 id)
+{
+    // Interned strings outlive the matches so there's nothing to copy.
+    if (InternedStrings::get().get_string(id) == nullptr)
+        return false;
+
+    _infos.push_back({ id });
+    add_info();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void MatchesImpl::add_info()
+{
+    // Matches added once the others have been selected, by generators that
+    // were still running, aren't counted until they're selected again.
+    if (!_coalesced)
+        ++_count;
+}
+
 //------------------------------------------------------------------------------
 void MatchesImpl::coalesce(uint32 count_hint)
 {
@@ -10,10 +10,12 @@
 //------------------------------------------------------------------------------
 struct MatchInfo
 {
+    uint32          interned_id; // Non-zero if the match is an InternedStrings id.
     uint16          store_id;
     uint16          displayable_store_id;
     uint16          aux_store_id;
-    uint8           cell_count;
+    uint16          cell_count : 15;
+    uint16          has_cell_count : 1; // Measured lazily, after selection.
     uint8           suffix : 7; // TODO: suffix can be in Store instead of info.
     uint8           select : 1;
 };
@@ -25,6 +27,7 @@ class MatchStore
 {
 public:
     const char*             get(uint32 id) const;
+    const char*             get(const MatchInfo& info) const;
 
 protected:
     static const int32      alignment_bits = 1;
@@ -55,7 +58,9 @@ private:
     friend class            MatchPipeline;
     friend class            MatchBuilder;
     void                    set_prefix_included(bool included);
-    bool                    add_match(const MatchDesc& desc);
+    bool                    add_match(const MatchDesc& desc, int32 match_length=-1);
+    bool                    add_interned_match(uint32 id);
+    void                    add_info();
     uint32                  get_info_count() const;
     MatchInfo*              get_infos();
     const MatchStore&       get_store() const;
@@ -70,11 +75,12 @@ private:
                             StoreImpl(uint32 size);
                             ~StoreImpl();
         void                reset();
-        int32               store_front(const char* str);
-        int32               store_back(const char* str);
+        int32               store_front(const char* str, int32 length=-1);
+        int32               store_back(const char* str, int32 length=-1);
 
     private:
-        uint32              get_size(const char* str) const;
+        uint32              get_size(const char* str, int32 length) const;
+        void                copy(uint32 offset, const char* str, uint32 length);
         uint32              _front;
         uint32              _back;
     };
@@ -34,10 +34,10 @@ extern void         (*rl_fflush_function)(FILE*);
 extern char*        _rl_comment_begin;
 extern int32        _rl_convert_meta_chars_to_ascii;
 extern int32        _rl_output_meta_chars;
+extern int32        _rl_last_v_pos;
 #if defined(PLATFORM_WINDOWS)
 extern int32        _rl_vis_botlin;
 extern int32        _rl_last_c_pos;
-extern int32        _rl_last_v_pos;
 #endif
 } // extern "C"
 
@@ -89,6 +89,24 @@ static void load_user_inputrc()
 
 
 
+//------------------------------------------------------------------------------
+static void build_rl_prompt(const char* prompt, StrBase& out)
+{
+    // Readline needs to be told about parts of the prompt that aren't visible
+    // by enclosing them in a pair of 0x01/0x02 chars.
+    Ecma48State state;
+    Ecma48Iter iter(prompt, state);
+    while (const Ecma48Code& code = iter.next())
+    {
+        bool c1 = (code.get_type() == Ecma48Code::type_c1);
+        if (c1) out.concat("\x01", 1);
+                out.concat(code.get_pointer(), code.get_length());
+        if (c1) out.concat("\x02", 1);
+    }
+}
+
+
+
 //------------------------------------------------------------------------------
 enum {
     bind_id_input,
@@ -189,19 +207,8 @@ void RlModule::on_begin_line(const Context& context)
 {
     rl_outstream = (FILE*)(TerminalOut*)(&context.printer);
 
-    // Readline needs to be told about parts of the prompt that aren't visible
-    // by enclosing them in a pair of 0x01/0x02 chars.
     Str<128> rl_prompt;
-
-    Ecma48State state;
-    Ecma48Iter iter(context.prompt, state);
-    while (const Ecma48Code& code = iter.next())
-    {
-        bool c1 = (code.get_type() == Ecma48Code::type_c1);
-        if (c1) rl_prompt.concat("\x01", 1);
-                rl_prompt.concat(code.get_pointer(), code.get_length());
-        if (c1) rl_prompt.concat("\x02", 1);
-    }
+    build_rl_prompt(context.prompt, rl_prompt);
 
     auto handler = [] (char* line) { RlModule::get()->done(line); };
     rl_callback_handler_install(rl_prompt.c_str(), handler);
@@ -244,7 +251,8 @@ void RlModule::on_input(const Input& Input, Result& result, const Context& conte
     {
         virtual void    begin() override   {}
         virtual void    end() override     {}
-        virtual void    select() override  {}
+        virtual void    select(int32) override {}
+        virtual bool    has_input() const override { return *data != '\0'; }
         virtual int32   read() override    { return *(uint8*)(data++); }
         const char*     data;
     } term_in;
@@ -396,3 +404,30 @@ void RlModule::on_terminal_resize(int32 columns, int32 rows, const Context& cont
     prev_columns = columns;
 #endif
 }
+
+//------------------------------------------------------------------------------
+void RlModule::on_prompt_changed(const Context& context)
+{
+    // Readline's display starts at the prompt's last line. Any lines above that
+    // are counted too so the cursor can be taken to the top of the old prompt.
+    int32 columns = max(int32(context.printer.get_columns()), 1);
+    int32 rows = _rl_last_v_pos;
+
+    Str<128> line;
+    for (const char* c = rl_prompt; const char* nl = strchr(c, '\n'); c = nl + 1)
+    {
+        line.clear();
+        line.concat(c, int32(nl - c));
+        rows += 1 + int32(cell_count(line.c_str())) / columns;
+    }
+
+    // Clear everything that's been drawn and let the editor redraw the line
+    // with the new prompt.
+    Str<32> clear;
+    clear.format((rows > 0) ? "\r\x1b[%dA\x1b[J" : "\r\x1b[J", rows);
+    context.printer.print(clear.c_str(), clear.length());
+
+    Str<128> prompt;
+    build_rl_prompt(context.prompt, prompt);
+    rl_set_prompt(prompt.c_str());
+}
@@ -23,6 +23,7 @@ private:
     virtual void    on_matches_changed(const Context& context) override;
     virtual void    on_input(const Input& Input, Result& result, const Context& context) override;
     virtual void    on_terminal_resize(int32 columns, int32 rows, const Context& context) override;
+    virtual void    on_prompt_changed(const Context& context) override;
     void            done(const char* line);
     char*           _rl_buffer;
     int32           _prev_group;
@@ -320,3 +320,8 @@ TabCompleter::State TabCompleter::print(const Context& context, bool single_row)
 void TabCompleter::on_terminal_resize(int32 columns, int32 rows, const Context& context)
 {
 }
+
+//------------------------------------------------------------------------------
+void TabCompleter::on_prompt_changed(const Context& context)
+{
+}
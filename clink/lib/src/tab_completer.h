@@ -26,6 +26,7 @@ private:
     virtual void    on_matches_changed(const Context& context) override;
     virtual void    on_input(const Input& input, Result& result, const Context& context) override;
     virtual void    on_terminal_resize(int32 columns, int32 rows, const Context& context) override;
+    virtual void    on_prompt_changed(const Context& context) override;
     State           begin_print(const Context& context);
     State           print(const Context& context, bool single_row);
     int32           _longest = 0;
@@ -6,6 +6,8 @@
 #include "binder.h"
 #include "editor_module.h"
 
+#include <core/str.h>
+
 //------------------------------------------------------------------------------
 TEST_CASE("binder")
 {
@@ -30,36 +32,101 @@ TEST_CASE("binder")
         REQUIRE(binder.get_group("group2") == groups[1]);
     }
 
-    SECTION("Overflow : group")
+    SECTION("Many groups")
     {
-        for (int32 i = 1; i < 256; ++i)
-            REQUIRE(binder.create_group("group") == (i * 2) + 1);
+        int32 groups[1000];
+        for (int32 i = 0; i < sizeof_array(groups); ++i)
+        {
+            Str<16> name;
+            name.format("group%d", i);
+            groups[i] = binder.create_group(name.c_str());
+            REQUIRE(groups[i] != -1);
+        }
+
+        for (int32 i = 0; i < sizeof_array(groups); ++i)
+        {
+            Str<16> name;
+            name.format("group%d", i);
+            REQUIRE(binder.get_group(name.c_str()) == groups[i]);
+        }
 
-        REQUIRE(binder.create_group("group") == -1);
+        // The most recent group of a name is the one found.
+        int32 again = binder.create_group("group0");
+        REQUIRE(again != groups[0]);
+        REQUIRE(binder.get_group("group0") == again);
     }
 
-    SECTION("Overflow : module")
+    SECTION("Many modules")
     {
         int32 group = binder.get_group();
-        for (int32 i = 0; i < 64; ++i)
+        for (int32 i = 0; i < 1000; ++i)
             REQUIRE(binder.bind(group, "", ((EditorModule*)0)[i], char(i)));
 
-        auto& module = ((EditorModule*)0)[0xff];
-        REQUIRE(!binder.bind(group, "", module, 0xff));
+        // Catch-all binds are offered in the order they were bound.
+        BindResolver resolver(binder);
+        REQUIRE(resolver.step('z'));
+        for (int32 i = 0; i < 1000; ++i)
+        {
+            auto binding = resolver.next();
+            REQUIRE(binding);
+            REQUIRE(binding.get_module() == &((EditorModule*)0)[i]);
+            REQUIRE(binding.get_id() == uint8(i));
+        }
     }
 
-    SECTION("Overflow : bind")
+    SECTION("Many binds")
     {
         auto& null_module = *(EditorModule*)0;
         int32 default_group = binder.get_group();
 
-        for (int32 i = 0; i < 508; ++i)
+        for (int32 i = 0; i < 4096; ++i)
         {
-            char chord[] = { char((i > 0xff) + 1), char((i % 0xfe) + 1), 0 };
-            REQUIRE(binder.bind(default_group, chord, null_module, 0x12));
+            char chord[] = { char((i >> 6) + 1), char((i & 0x3f) + 0xa0), char((i % 0x5b) + 1), 0 };
+            REQUIRE(binder.bind(default_group, chord, null_module, uint8(i)));
         }
 
-        REQUIRE(!binder.bind(default_group, "\x01\x02\x03", null_module, 0x12));
+        for (int32 i = 0; i < 4096; i += 7)
+        {
+            char chord[] = { char((i >> 6) + 1), char((i & 0x3f) + 0xa0), char((i % 0x5b) + 1), 0 };
+
+            BindResolver resolver(binder);
+            for (const char* c = chord; *c; ++c)
+                if (resolver.step(*c))
+                    break;
+
+            auto binding = resolver.next();
+            REQUIRE(binding);
+            REQUIRE(binding.get_id() == uint8(i));
+        }
+    }
+
+    SECTION("Escape sequences")
+    {
+        auto& esc_module = *(EditorModule*)0x10;
+        auto& csi_module = *(EditorModule*)0x20;
+        int32 group = binder.get_group();
+        REQUIRE(binder.bind(group, "\\e", esc_module, 1));
+        REQUIRE(binder.bind(group, "\\e[A", csi_module, 2));
+        REQUIRE(binder.bind(group, "\\e[1;5A", csi_module, 3));
+
+        // ESC and ESC [ have more to come.
+        BindResolver resolver(binder);
+        REQUIRE(!resolver.step('\x1b'));
+        REQUIRE(!resolver.step('['));
+        REQUIRE(resolver.step('A'));
+
+        // Longest chord first, then shorter ones it starts with.
+        auto binding = resolver.next();
+        REQUIRE(binding);
+        REQUIRE(binding.get_module() == &csi_module);
+        REQUIRE(binding.get_id() == 2);
+
+        binding = resolver.next();
+        REQUIRE(binding);
+        REQUIRE(binding.get_module() == &esc_module);
+        REQUIRE(binding.get_id() == 1);
+
+        REQUIRE(!resolver.next());
     }
 
     SECTION("Valid chords")
@@ -5,8 +5,10 @@
 #include "line_editor_tester.h"
 #include "editor_module.h"
 #include "line_state.h"
+#include "match_generator.h"
 
 #include <core/array.h>
+#include <core/str.h>
 
 //------------------------------------------------------------------------------
 struct DelimModule
@@ -18,6 +20,7 @@ struct DelimModule
     virtual void    on_matches_changed(const Context& context) override;
     virtual void    on_input(const Input& Input, Result& result, const Context& context) override {}
     virtual void    on_terminal_resize(int32 columns, int32 rows, const Context& context) override {}
+    virtual void    on_prompt_changed(const Context& context) override {}
     uint8           delim = 'a';
 };
 
@@ -84,3 +87,125 @@ TEST_CASE("editor")
         REQUIRE(module.delim == '=');
     }
 }
+
+//------------------------------------------------------------------------------
+struct WordsModule
+    : public DelimModule
+{
+    virtual void    on_matches_changed(const Context& context) override;
+    Str<64>         words;
+};
+
+//------------------------------------------------------------------------------
+void WordsModule::on_matches_changed(const Context& context)
+{
+    const LineState& line = context.line;
+
+    words.clear();
+    for (uint32 i = 0, n = line.get_word_count(); i < n; ++i)
+    {
+        if (i)
+            words << ",";
+        line.get_word(i, words);
+    }
+}
+
+//------------------------------------------------------------------------------
+struct WholeWordGenerator
+    : public MatchGenerator
+{
+    virtual bool    generate(const LineState& line, MatchBuilder& builder) override { return false; }
+    virtual int32   get_prefix_length(const LineState& line) const override { return line.get_end_word().length(); }
+};
+
+//------------------------------------------------------------------------------
+TEST_CASE("editor words")
+{
+    LineEditor::Desc desc;
+    desc.command_delims = "&";
+    LineEditorTester tester(desc);
+
+    WordsModule module;
+    WholeWordGenerator generator;
+    LineEditor* editor = tester.get_editor();
+    editor->add_module(module);
+    editor->add_generator(generator);
+
+    // Each edit only lexes the line again from where it changed.
+    const struct {
+        const char* input;
+        const char* words;
+    } steps[] = {
+        { "one two three",            "one,two,three" },
+        { "\x02\x02\x02\x02\x02\x02", "one,tw" },
+        { "X",                        "one,twX" },
+        { "\x06\x06\x06\x06\x06\x06", "one,twXo,three" },
+        { " & \"a b\" c",             "a b,c" },
+        { "\b\b\b\b\b\b\b\b",         "" },
+        { "\b",                       "one,twXo,three," },
+    };
+
+    for (const auto& step : steps)
+    {
+        tester.set_input(step.input);
+        tester.run(true);
+        REQUIRE(module.words.equals(step.words), [&] () {
+            printf(" input; %s#\n", step.input);
+            printf("expected; %s#\n", step.words);
+            printf("     got; %s#\n", module.words.c_str());
+        });
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("editor long line")
+{
+    LineEditorTester tester;
+
+    WordsModule module;
+    WholeWordGenerator generator;
+    LineEditor* editor = tester.get_editor();
+    editor->add_module(module);
+    editor->add_generator(generator);
+
+    // More words than used to fit, the last of which is longer than 1023
+    // characters and ends beyond the reach of the old 11-bit match keys.
+    Str<> input;
+    for (int32 i = 0; i < 2000; ++i)
+        input << "w ";
+
+    Str<> expected;
+    for (int32 i = 0; i < 2000; ++i)
+        expected << "w,";
+
+    for (int32 i = 0; i < 1500; ++i)
+    {
+        input << "x";
+        expected << "x";
+    }
+
+    tester.set_input(input.c_str());
+    tester.run(true);
+    REQUIRE(module.words.equals(expected.c_str()));
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("editor render")
+{
+    LineEditorTester tester;
+    HeadlessScreenBuffer& screen = tester.get_screen();
+
+    tester.set_input("abc");
+    tester.run(true);
+
+    Str<1024> snapshot;
+    screen.snapshot(snapshot);
+    REQUIRE(strstr(snapshot.c_str(), "abc") != nullptr, [&] () {
+        printf("screen; %s#\n", snapshot.c_str());
+    });
+
+    // Each update's output is flushed once.
+    const HeadlessScreenBuffer::Stats& stats = screen.get_stats();
+    REQUIRE(stats.bytes > 0);
+    REQUIRE(stats.flushes >= 3);
+}
@@ -0,0 +1,58 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "match_pipeline.h"
+#include "matches_impl.h"
+
+#include <lib/interned_strings.h>
+
+//------------------------------------------------------------------------------
+TEST_CASE("Interned strings")
+{
+    InternedStrings& interned = InternedStrings::get();
+
+    SECTION("Dedupe")
+    {
+        uint32 a = interned.intern("interned_Abc", 12);
+        uint32 b = interned.intern("interned_Abcdef", 12);
+        uint32 c = interned.intern("interned_Abd", 12);
+        REQUIRE(a != 0);
+        REQUIRE(a == b);
+        REQUIRE(a != c);
+        REQUIRE(interned.intern("", 0) == 0);
+    }
+
+    SECTION("Entry")
+    {
+        uint32 id = interned.intern("interned_XyZ", 12);
+        REQUIRE(strcmp(interned.get_string(id), "interned_XyZ") == 0);
+        REQUIRE(strcmp(interned.get_sort_key(id), "interned_xyz") == 0);
+        REQUIRE(interned.get_length(id) == 12);
+        REQUIRE(interned.get_cell_count(id) == 12);
+        REQUIRE(interned.get_string(0) == nullptr);
+        REQUIRE(interned.get_string(interned.get_count() + 1) == nullptr);
+    }
+
+    SECTION("Matches")
+    {
+        MatchesImpl matches;
+        MatchPipeline pipeline(matches);
+        MatchBuilder builder(matches);
+
+        builder.add_interned_match(interned.intern("Two", 3));
+        builder.add_match("three");
+        builder.add_interned_match(interned.intern("one", 3));
+        REQUIRE(!builder.add_interned_match(0));
+
+        pipeline.fill_info();
+        pipeline.select("");
+        pipeline.sort();
+
+        REQUIRE(matches.get_match_count() == 3);
+        REQUIRE(strcmp(matches.get_match(0), "one") == 0);
+        REQUIRE(strcmp(matches.get_match(1), "three") == 0);
+        REQUIRE(strcmp(matches.get_match(2), "Two") == 0);
+        REQUIRE(matches.get_cell_count(2) == 3);
+    }
+}
@@ -0,0 +1,40 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "match_pipeline.h"
+#include "matches_impl.h"
+
+#include <core/str.h>
+
+//------------------------------------------------------------------------------
+TEST_CASE("Match cell counts")
+{
+    MatchesImpl matches;
+    MatchPipeline pipeline(matches);
+    MatchBuilder builder(matches);
+
+    Str<512> long_name;
+    for (int32 i = 0; i < 300; ++i)
+        long_name << "x";
+
+    builder.add_match(long_name.c_str());
+    builder.add_match("\xe4\xb8\xad\xf0\x9f\x98\x80");
+    builder.add_match("abc");
+
+    // Info's filled in for what's selected, and again once selection changes.
+    pipeline.select("x");
+    pipeline.fill_info();
+
+    REQUIRE(matches.get_match_count() == 1);
+    REQUIRE(matches.get_cell_count(0) == 300);
+
+    pipeline.select("");
+    pipeline.fill_info();
+    pipeline.sort();
+
+    REQUIRE(matches.get_match_count() == 3);
+    REQUIRE(matches.get_cell_count(0) == 3);
+    REQUIRE(matches.get_cell_count(1) == 300);
+    REQUIRE(matches.get_cell_count(2) == 4);
+}
@@ -17,11 +17,18 @@ public:
 
 private:
     virtual bool    generate(const LineState& line, MatchBuilder& Builder) override;
+    virtual bool    resume(const LineState& line, MatchBuilder& Builder) override;
+    virtual bool    is_pending() const override;
     virtual int32   get_prefix_length(const LineState& line) const override;
+    bool            call(const char* name, const LineState& line, MatchBuilder& Builder);
+    void            release_pending();
     void            initialise();
     void            print_error(const char* error) const;
     void            lua_pushlinestate(const LineState& line);
     bool            load_script(const char* script);
     void            load_scripts(const char* path);
     LuaState&       _state;
+    int32           _line_ref;
+    int32           _builder_ref;
+    bool            _pending = false;
 };
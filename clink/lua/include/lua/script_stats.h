@@ -0,0 +1,44 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <core/str.h>
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Process-wide timings of Lua generators and prompt filters, which outlive the
+// Lua state each line creates. Scripts are identified by where their function
+// is defined. One that overruns the 'lua.budget' setting is logged, and if it
+// does so 'lua.skip_after' times in a row it is skipped from then on.
+class ScriptStats
+{
+public:
+    struct Entry
+    {
+        enum : uint32 { sample_count = 128 };
+        Str<96>             name;
+        uint32              count = 0;
+        uint32              overruns = 0;
+        double              total = 0;
+        float               samples[sample_count];
+        bool                skipped = false;
+
+        double              get_mean() const;
+        double              get_p99() const;
+    };
+
+    static ScriptStats&     get();
+    void                    record(const char* name, double seconds);
+    bool                    is_skipped(const char* name) const;
+    uint32                  get_count() const;
+    const Entry&            get_entry(uint32 index) const;
+    bool                    save(const char* path);
+    void                    reset();
+
+private:
+    const Entry*            find(const char* name) const;
+    std::vector<Entry>      _entries;
+    bool                    _dirty = false;
+};
@@ -17,83 +17,8 @@ end
 
 
 --------------------------------------------------------------------------------
-local _argreader = {}
-_argreader.__index = _argreader
-setmetatable(_argreader, { __call = function (x, ...) return x._new(...) end })
-
---------------------------------------------------------------------------------
-function _argreader._new(root)
-    local reader = setmetatable({
-        _matcher = root,
-        _arg_index = 1,
-        _stack = {},
-    }, _argreader)
-    return reader
-end
-
---------------------------------------------------------------------------------
-function _argreader:update(word)
-    -- Check for flags and swtich matcher if the word is a flag.
-    local matcher = self._matcher
-    local is_flag = matcher:_is_flag(word)
-    if is_flag then
-        if matcher._flags then
-            self:_push(matcher._flags)
-        else
-            return
-        end
-    end
-
-    matcher = self._matcher
-    local arg_index = self._arg_index
-    local arg = matcher._args[arg_index]
-
-    arg_index = arg_index + 1
-
-    -- If arg_index is out of bounds we should loop if set or return to the
-    -- previous matcher if possible.
-    if arg_index > #matcher._args then
-        if matcher._loop then
-            self._arg_index = math.min(math.max(matcher._loop, 1), #matcher._args)
-        elseif not self:_pop() then
-            self._arg_index = arg_index
-        end
-    else
-        self._arg_index = arg_index
-    end
-
-    -- Some matchers have no args at all.
-    if not arg then
-        return
-    end
-
-    -- Does the word lead to another matcher?
-    for key, linked in pairs(arg._links) do
-        if key == word then
-            self:_push(linked)
-            break
-        end
-    end
-end
-
---------------------------------------------------------------------------------
-function _argreader:_push(matcher)
-    table.insert(self._stack, { self._matcher, self._arg_index })
-    self._matcher = matcher
-    self._arg_index = 1
-end
-
---------------------------------------------------------------------------------
-function _argreader:_pop()
-    if #self._stack > 0 then
-        self._matcher, self._arg_index = table.unpack(table.remove(self._stack))
-        return true
-    end
-
-    return false
-end
-
-
+-- Bumped whenever any argmatcher is changed so compiled trees can be rebuilt.
+local _generation = 0
 
 --------------------------------------------------------------------------------
 local _argmatcher = {}
@@ -117,6 +42,7 @@ function _argmatcher:addarg(...)
     local list = { _links = {} }
     self:_add(list, {...})
     table.insert(self._args, list)
+    _generation = _generation + 1
     return self
 end
 
@@ -131,6 +57,7 @@ function _argmatcher:addflags(...)
 
     flag_matcher._args[1] = list
     self._flags = flag_matcher
+    _generation = _generation + 1
     return self
 end
 
@@ -140,6 +67,7 @@ end
 --- -ret:   self
 function _argmatcher:loop(index)
     self._loop = index or -1
+    _generation = _generation + 1
     return self
 end
 
@@ -155,6 +83,7 @@ function _argmatcher:setflagprefix(...)
     end
 
     self._flagprefix = {...}
+    _generation = _generation + 1
     return self
 end
 
@@ -163,6 +92,7 @@ end
 --- -ret:   self
 function _argmatcher:nofiles()
     self._no_file_generation = true
+    _generation = _generation + 1
     return self
 end
 
@@ -246,58 +176,58 @@ function _argmatcher:_add(list, addee)
 end
 
 --------------------------------------------------------------------------------
-function _argmatcher:_generate(line_state, match_builder)
-    local reader = _argreader(self)
-
-    -- Consume words and use them to move through matchers' arguments.
-    local word_count = line_state:getwordcount()
-    for word_index = 2, (word_count - 1) do
-        local word = line_state:getword(word_index)
-        reader:update(word)
+function _argmatcher:_get_tree()
+    -- Argmatchers are compiled into a native tree that the line's words are
+    -- stepped through. It is only rebuilt if an argmatcher's been changed.
+    if self._tree_generation ~= _generation then
+        self._tree = clink._compileargmatcher(self)
+        self._tree_generation = _generation
     end
 
-    -- There should always be a matcher left on the stack, but the arg_index
-    -- could be well out of range.
-    local matcher = reader._matcher
-    local arg_index = reader._arg_index
+    return self._tree
+end
 
-    -- Are we left with a valid argument that can provide matches?
-    local add_matches = function(arg)
-        for key, _ in pairs(arg._links) do
-            match_builder:addmatch(key)
+--------------------------------------------------------------------------------
+function _argmatcher:_generate(line_state, match_builder)
+    -- The tree adds the matches it knows about. Functions and tables in the
+    -- resulting argument are left to be added here. Builders that aren't native
+    -- (such as deferred ones) get the tree's matches back to add themselves.
+    local tree = self:_get_tree()
+    local arg, ret, is_flags, choices = tree:generate(line_state, match_builder)
+    if choices then
+        if is_flags then
+            match_builder:setprefixincluded(true)
         end
+        match_builder:addmatches(choices)
+    end
 
-        for _, i in ipairs(arg) do
-            if type(i) == "function" then
-                local j = i(word_count, line_state, match_builder)
-                if type(j) ~= "table" then
-                    return j or false
+    if arg then
+        local word_count = line_state:getwordcount()
+        local add_matches = function(arg)
+            for _, i in ipairs(arg) do
+                local t = type(i)
+                if t == "function" then
+                    local j = i(word_count, line_state, match_builder)
+                    if type(j) ~= "table" then
+                        return j or false
+                    end
+
+                    match_builder:addmatches(j)
+                elseif t == "table" then
+                    match_builder:addmatch(i)
                 end
-
-                match_builder:addmatches(j)
-            else
-                match_builder:addmatch(i)
             end
-        end
 
-        return true
-    end
+            return true
+        end
 
-    -- Select between adding flags or matches themselves. Works in conjunction
-    -- with getprefixlength()'s return.
-    if matcher._flags and matcher:_is_flag(line_state:getendword()) then
-        match_builder:setprefixincluded()
-        add_matches(matcher._flags._args[1])
-    else
-        local arg = matcher._args[arg_index]
-        if arg then
-            return add_matches(arg) and true or false
+        local added = add_matches(arg)
+        if not is_flags then
+            return added and true or false
         end
     end
 
-    -- No valid argument. Decide if we should match files or not.
-    local no_files = matcher._no_file_generation or #matcher._args == 0
-    return no_files
+    return ret
 end
 
 
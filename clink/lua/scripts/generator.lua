@@ -5,6 +5,7 @@
 clink = clink or {}
 local _generators = {}
 local _generators_unsorted = false
+local _jobs = {}
 
 
 
@@ -21,6 +22,22 @@ local function pcall_dispatch(func, ...)
     return ret
 end
 
+--------------------------------------------------------------------------------
+-- Generators are identified in timings by where their generate() is defined.
+local function get_name(generator)
+    if not generator._name then
+        local func = generator.generate
+        if type(func) == "function" then
+            local info = debug.getinfo(func, "S")
+            generator._name = info.short_src .. ":" .. info.linedefined
+        else
+            generator._name = tostring(generator)
+        end
+    end
+
+    return generator._name
+end
+
 --------------------------------------------------------------------------------
 local function prepare()
     -- Sort generators by priority if required.
@@ -33,21 +50,182 @@ local function prepare()
 end
 
 --------------------------------------------------------------------------------
-function clink._generate(line_state, match_builder)
-    local impl = function ()
-        for _, generator in ipairs(_generators) do
-            local ret = generator:generate(line_state, match_builder)
-            if ret == true then
-                return true
+-- Records calls made to a match builder so they can be played back later.
+-- Generators that start while an earlier one is still suspended use one of
+-- these so matches are only added if the earlier generators don't claim the
+-- line by returning true. Once committed, calls are passed straight through.
+local _deferred_builder = {}
+_deferred_builder.__index = _deferred_builder
+
+--------------------------------------------------------------------------------
+function _deferred_builder._new()
+    return setmetatable({ _calls = {} }, _deferred_builder)
+end
+
+--------------------------------------------------------------------------------
+function _deferred_builder:addmatch(match)
+    if self._target then
+        return self._target:addmatch(match)
+    end
+
+    table.insert(self._calls, { "addmatch", match })
+    return true
+end
+
+--------------------------------------------------------------------------------
+function _deferred_builder:addmatches(matches)
+    if self._target then
+        return self._target:addmatches(matches)
+    end
+
+    -- Functions are drained now as they may depend on the generator's state.
+    if type(matches) == "function" then
+        local drained = {}
+        for match in matches do
+            table.insert(drained, match)
+        end
+        matches = drained
+    end
+
+    table.insert(self._calls, { "addmatches", matches })
+
+    -- Counted as the native builder would; strings hold a match per line.
+    local count = 0
+    if type(matches) == "table" then
+        count = #matches
+    elseif type(matches) == "string" then
+        for line in matches:gmatch("[^\n]+") do
+            if line ~= "\r" then
+                count = count + 1
             end
         end
+    end
+
+    return count, true
+end
+
+--------------------------------------------------------------------------------
+function _deferred_builder:setprefixincluded(included)
+    if self._target then
+        return self._target:setprefixincluded(included)
+    end
+
+    table.insert(self._calls, { "setprefixincluded", included })
+end
+
+--------------------------------------------------------------------------------
+function _deferred_builder:_commit(match_builder)
+    for _, call in ipairs(self._calls) do
+        match_builder[call[1]](match_builder, call[2])
+    end
+
+    self._calls = {}
+    self._target = match_builder
+end
 
+--------------------------------------------------------------------------------
+-- Only io.popen2async() handles are waited on. Other userdata yielded may not
+-- be indexable, so the handles' metatable is checked for instead.
+local function is_async_handle(value)
+    if type(value) ~= "userdata" then
         return false
     end
 
+    local mt = getmetatable(value)
+    return mt ~= nil and mt == debug.getregistry().popen2async_mt
+end
+
+--------------------------------------------------------------------------------
+local function resume_generator(job, ...)
+    -- Only time spent running counts; not time spent suspended.
+    local start = clink.clock()
+    local ok, ret = coroutine.resume(job.co, ...)
+    job.elapsed = job.elapsed + clink.clock() - start
+    if not ok then
+        print("")
+        print(ret)
+        print(debug.traceback(job.co))
+        ret = nil
+    end
+
+    if coroutine.status(job.co) == "dead" then
+        job.done = true
+        job.ret = ret
+        job.wait = nil
+        clink._recordtiming(job.name, job.elapsed)
+    elseif is_async_handle(ret) then
+        job.wait = ret
+    else
+        job.wait = nil
+    end
+end
+
+--------------------------------------------------------------------------------
+-- Removes finished generators from the front of the line. Returns true if one
+-- of them claimed the line.
+local function settle(match_builder)
+    while #_jobs > 0 and _jobs[1].done do
+        local job = table.remove(_jobs, 1)
+        if job.ret == true then
+            _jobs = {}
+            return true
+        end
+
+        -- The next generator in line can now add to the builder directly.
+        if _jobs[1] then
+            _jobs[1].builder:_commit(match_builder)
+        end
+    end
+
+    return false
+end
+
+--------------------------------------------------------------------------------
+function clink._generate(line_state, match_builder)
     prepare()
-    local ret = pcall_dispatch(impl)
-    return ret or false
+
+    -- Each generator runs as a coroutine so it can yield while it waits on
+    -- something like a child process. Later generators are started meanwhile
+    -- so their waits overlap, but results are still claimed in priority order.
+    -- Those still suspended at the end are resumed by clink._resume_generators()
+    -- as the editor polls for input, so it isn't held up by them.
+    _jobs = {}
+    for _, generator in ipairs(_generators) do
+        local name = get_name(generator)
+        if not clink._isskipped(name) then
+            local job = { name = name, elapsed = 0 }
+            job.builder = (#_jobs > 0) and _deferred_builder._new() or match_builder
+            job.co = coroutine.create(function(builder)
+                return generator:generate(line_state, builder)
+            end)
+
+            table.insert(_jobs, job)
+            resume_generator(job, job.builder)
+            if settle(match_builder) then
+                return true, false
+            end
+        end
+    end
+
+    return false, #_jobs > 0
+end
+
+--------------------------------------------------------------------------------
+function clink._resume_generators(line_state, match_builder)
+    -- Generators that yielded an io.popen2async() handle are only resumed once
+    -- it's ready. The line state and builder are the ones the generators were
+    -- started with; the host points them at the current line and matches.
+    for _, job in ipairs(_jobs) do
+        if not job.done and not (job.wait and not job.wait:ready()) then
+            resume_generator(job)
+        end
+    end
+
+    if settle(match_builder) then
+        return true, false
+    end
+
+    return false, #_jobs > 0
 end
 
 --------------------------------------------------------------------------------
@@ -73,6 +251,13 @@ end
 --- -name:  clink.generator
 --- -arg:   [priority:integer]
 --- -ret:   table
+--- Generators' generate() functions are run as coroutines and can call
+--- coroutine.yield() while they wait on something like a child process. Other
+--- generators are run in the meantime and the editor carries on taking input,
+--- with matches shown as they are added. Yielding an io.popen2async() handle
+--- resumes the generator only once there is output to be read from it.
+--- Generators that repeatedly take longer than the 'lua.budget' setting to run
+--- are skipped.
 function clink.generator(priority)
     if priority == nil then priority = 999 end
 
@@ -0,0 +1,544 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "argmatcher_tree.h"
+#include "line_state_lua.h"
+#include "lua_state.h"
+#include "match_builder_lua.h"
+
+#include <core/array.h>
+#include <core/base.h>
+#include <lib/interned_strings.h>
+#include <lib/line_state.h>
+#include <lib/matches.h>
+
+#include <algorithm>
+#include <new>
+
+//------------------------------------------------------------------------------
+uint32 ArgmatcherTree::hash(const char* str, uint32 length)
+{
+    uint32 hash = 5381;
+    for (uint32 i = 0; i < length; ++i)
+        hash = ((hash << 5) + hash) ^ uint8(str[i]);
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+bool ArgmatcherTree::compile(lua_State* state, int32 root_index, int32 nodes_index)
+{
+    _nodes.clear();
+    _args.clear();
+    _choices.clear();
+    _links.clear();
+
+    root_index = lua_absindex(state, root_index);
+    nodes_index = lua_absindex(state, nodes_index);
+
+    // Maps each matcher table to its node so cycles are only compiled once.
+    lua_createtable(state, 0, 0);
+    int32 lookup_index = lua_gettop(state);
+
+    bool ok = (compile_node(state, root_index, lookup_index, nodes_index) == 0);
+
+    lua_pop(state, 1);
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+int32 ArgmatcherTree::compile_node(
+    lua_State* state,
+    int32 index,
+    int32 lookup_index,
+    int32 nodes_index)
+{
+    if (!lua_istable(state, index))
+        return -1;
+
+    lua_pushvalue(state, index);
+    lua_rawget(state, lookup_index);
+    if (lua_isnumber(state, -1))
+    {
+        int32 id = int32(lua_tointeger(state, -1));
+        lua_pop(state, 1);
+        return id;
+    }
+    lua_pop(state, 1);
+
+    int32 id = int32(_nodes.size());
+    _nodes.push_back({});
+
+    lua_pushvalue(state, index);
+    lua_pushinteger(state, id);
+    lua_rawset(state, lookup_index);
+
+    lua_pushvalue(state, index);
+    lua_rawseti(state, nodes_index, id + 1);
+
+    Node node = {};
+    node.flags = -1;
+
+    lua_getfield(state, index, "_loop");
+    if (node.looped = !lua_isnil(state, -1))
+        node.loop = int32(lua_tointeger(state, -1));
+    lua_pop(state, 1);
+
+    lua_getfield(state, index, "_no_file_generation");
+    node.no_files = (lua_toboolean(state, -1) != 0);
+    lua_pop(state, 1);
+
+    lua_getfield(state, index, "_flagprefix");
+    if (lua_istable(state, -1))
+    {
+        int32 count = int32(lua_rawlen(state, -1));
+        count = min<int32>(count, sizeof_array(node.flag_prefix) - 1);
+        for (int32 i = 1, j = 0; i <= count; ++i)
+        {
+            lua_rawgeti(state, -1, i);
+            if (const char* prefix = lua_tostring(state, -1))
+                node.flag_prefix[j++] = prefix[0];
+            lua_pop(state, 1);
+        }
+    }
+    lua_pop(state, 1);
+
+    lua_getfield(state, index, "_flags");
+    if (lua_istable(state, -1))
+        node.flags = compile_node(state, lua_gettop(state), lookup_index, nodes_index);
+    lua_pop(state, 1);
+
+    InternedStrings& interned = InternedStrings::get();
+
+    // Linked matchers are compiled as they're found which interleaves their
+    // args with ours, so ours are collected locally and appended at the end.
+    std::vector<Arg> args;
+    std::vector<uint32> choices;
+    std::vector<Link> links;
+
+    lua_getfield(state, index, "_args");
+    int32 args_index = lua_gettop(state);
+    for (int32 i = 1, n = lua_istable(state, -1) ? int32(lua_rawlen(state, -1)) : 0; i <= n; ++i)
+    {
+        lua_rawgeti(state, args_index, i);
+        int32 list_index = lua_gettop(state);
+
+        Arg arg = {};
+        arg.choice_begin = uint32(choices.size());
+        arg.link_begin = uint32(links.size());
+
+        if (lua_istable(state, list_index))
+        {
+            for (int32 j = 1, m = int32(lua_rawlen(state, list_index)); j <= m; ++j)
+            {
+                lua_rawgeti(state, list_index, j);
+                if (lua_isstring(state, -1))
+                {
+                    size_t length;
+                    const char* str = lua_tolstring(state, -1, &length);
+                    if (uint32 id = interned.intern(str, uint32(length)))
+                        choices.push_back(id);
+                }
+                else
+                    arg.dynamic = true;
+                lua_pop(state, 1);
+            }
+
+            lua_getfield(state, list_index, "_links");
+            if (lua_istable(state, -1))
+            {
+                int32 links_index = lua_gettop(state);
+                lua_pushnil(state);
+                while (lua_next(state, links_index))
+                {
+                    if (lua_type(state, -2) == LUA_TSTRING)
+                    {
+                        size_t length;
+                        const char* key = lua_tolstring(state, -2, &length);
+                        int32 linked = compile_node(state, lua_gettop(state), lookup_index, nodes_index);
+                        uint32 id = interned.intern(key, uint32(length));
+                        if (id && linked >= 0)
+                            links.push_back({ hash(key, uint32(length)), id, uint32(linked) });
+                    }
+                    lua_pop(state, 1);
+                }
+            }
+            lua_pop(state, 1);
+        }
+
+        arg.choice_count = uint32(choices.size() - arg.choice_begin);
+        arg.link_count = uint32(links.size() - arg.link_begin);
+        args.push_back(arg);
+
+        lua_pop(state, 1);
+    }
+    lua_pop(state, 1);
+
+    // Sort each arg's links by hash so words can be found with a binary search.
+    uint32 choice_base = uint32(_choices.size());
+    uint32 link_base = uint32(_links.size());
+    for (Arg& arg : args)
+    {
+        auto* begin = links.data() + arg.link_begin;
+        std::sort(begin, begin + arg.link_count, [] (const Link& lhs, const Link& rhs) {
+            return lhs.hash < rhs.hash;
+        });
+
+        arg.choice_begin += choice_base;
+        arg.link_begin += link_base;
+    }
+
+    node.arg_begin = uint32(_args.size());
+    node.arg_count = uint32(args.size());
+
+    _args.insert(_args.end(), args.begin(), args.end());
+    _choices.insert(_choices.end(), choices.begin(), choices.end());
+    _links.insert(_links.end(), links.begin(), links.end());
+    _nodes[id] = node;
+
+    return id;
+}
+
+//------------------------------------------------------------------------------
+bool ArgmatcherTree::is_flag(uint32 node, const char* word, uint32 length) const
+{
+    if (node >= _nodes.size() || !length)
+        return false;
+
+    const char* prefix = _nodes[node].flag_prefix;
+    for (; *prefix; ++prefix)
+        if (*prefix == word[0])
+            return true;
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+const ArgmatcherTree::Link* ArgmatcherTree::find_link(
+    const Arg& arg,
+    const char* word,
+    uint32 length) const
+{
+    if (!arg.link_count)
+        return nullptr;
+
+    uint32 word_hash = hash(word, length);
+
+    const Link* begin = _links.data() + arg.link_begin;
+    const Link* end = begin + arg.link_count;
+    const Link* link = std::lower_bound(begin, end, word_hash, [] (const Link& lhs, uint32 rhs) {
+        return lhs.hash < rhs;
+    });
+
+    const InternedStrings& interned = InternedStrings::get();
+    for (; link < end && link->hash == word_hash; ++link)
+        if (interned.get_length(link->key) == length)
+            if (memcmp(interned.get_string(link->key), word, length) == 0)
+                return link;
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+void ArgmatcherTree::Walker::push(uint32 node)
+{
+    stack.push_back(current);
+    current = { node, 1 };
+}
+
+//------------------------------------------------------------------------------
+bool ArgmatcherTree::Walker::pop()
+{
+    if (stack.empty())
+        return false;
+
+    current = stack.back();
+    stack.pop_back();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ArgmatcherTree::step(Walker& walker, const char* word, uint32 length) const
+{
+    // Check for flags and switch matcher if the word is a flag.
+    if (is_flag(walker.current.node, word, length))
+    {
+        int32 flags = _nodes[walker.current.node].flags;
+        if (flags < 0)
+            return;
+
+        walker.push(flags);
+    }
+
+    const Node& node = _nodes[walker.current.node];
+    int32 arg_index = walker.current.arg_index;
+    const Arg* arg = nullptr;
+    if (arg_index >= 1 && arg_index <= node.arg_count)
+        arg = &(_args[node.arg_begin + arg_index - 1]);
+
+    ++arg_index;
+
+    // If arg_index is out of bounds we should loop if set or return to the
+    // previous matcher if possible.
+    if (arg_index > node.arg_count)
+    {
+        if (node.looped)
+            walker.current.arg_index = min(max(node.loop, 1), int32(node.arg_count));
+        else if (!walker.pop())
+            walker.current.arg_index = arg_index;
+    }
+    else
+        walker.current.arg_index = arg_index;
+
+    // Some matchers have no args at all.
+    if (arg == nullptr)
+        return;
+
+    // Does the word lead to another matcher?
+    if (const Link* link = find_link(*arg, word, length))
+        walker.push(link->node);
+}
+
+//------------------------------------------------------------------------------
+ArgmatcherTree::Position ArgmatcherTree::walk(const LineState& line) const
+{
+    Walker walker;
+    walker.current = { 0, 1 };
+
+    if (_nodes.empty())
+        return walker.current;
+
+    // Consume words and use them to move through matchers' arguments. The
+    // first word is the command and the last is the one being completed.
+    const Array<Word>& words = line.get_words();
+    const char* line_str = line.get_line();
+    for (uint32 i = 1, n = line.get_word_count(); i + 1 < n; ++i)
+    {
+        const Word* word = words[i];
+        step(walker, line_str + word->offset, word->length);
+    }
+
+    return walker.current;
+}
+
+//------------------------------------------------------------------------------
+int32 ArgmatcherTree::get_flags(uint32 node) const
+{
+    return (node < _nodes.size()) ? _nodes[node].flags : -1;
+}
+
+//------------------------------------------------------------------------------
+bool ArgmatcherTree::has_arg(const Position& position) const
+{
+    if (position.node >= _nodes.size())
+        return false;
+
+    const Node& node = _nodes[position.node];
+    return (position.arg_index >= 1 && position.arg_index <= node.arg_count);
+}
+
+//------------------------------------------------------------------------------
+bool ArgmatcherTree::has_files(uint32 node) const
+{
+    if (node >= _nodes.size())
+        return true;
+
+    return !_nodes[node].no_files && _nodes[node].arg_count;
+}
+
+//------------------------------------------------------------------------------
+bool ArgmatcherTree::add_matches(const Position& position, MatchBuilder& builder) const
+{
+    if (!has_arg(position))
+        return false;
+
+    const Node& node = _nodes[position.node];
+    const Arg& arg = _args[node.arg_begin + position.arg_index - 1];
+
+    const Link* link = _links.data() + arg.link_begin;
+    for (uint32 i = 0; i < arg.link_count; ++i, ++link)
+        builder.add_interned_match(link->key);
+
+    const uint32* choice = _choices.data() + arg.choice_begin;
+    for (uint32 i = 0; i < arg.choice_count; ++i, ++choice)
+        builder.add_interned_match(*choice);
+
+    return arg.dynamic;
+}
+
+//------------------------------------------------------------------------------
+// As add_matches() but the matches are pushed on to the Lua stack as a table of
+// strings, for builders that aren't native.
+bool ArgmatcherTree::push_matches(const Position& position, lua_State* state) const
+{
+    if (!has_arg(position))
+    {
+        lua_createtable(state, 0, 0);
+        return false;
+    }
+
+    const Node& node = _nodes[position.node];
+    const Arg& arg = _args[node.arg_begin + position.arg_index - 1];
+    lua_createtable(state, arg.link_count + arg.choice_count, 0);
+
+    const InternedStrings& interned = InternedStrings::get();
+    auto push_id = [&] (uint32 id, int32 index) {
+        lua_pushlstring(state, interned.get_string(id), interned.get_length(id));
+        lua_rawseti(state, -2, index);
+    };
+
+    int32 index = 0;
+    const Link* link = _links.data() + arg.link_begin;
+    for (uint32 i = 0; i < arg.link_count; ++i, ++link)
+        push_id(link->key, ++index);
+
+    const uint32* choice = _choices.data() + arg.choice_begin;
+    for (uint32 i = 0; i < arg.choice_count; ++i, ++choice)
+        push_id(*choice, ++index);
+
+    return arg.dynamic;
+}
+
+
+
+//------------------------------------------------------------------------------
+static ArgmatcherTree* check_tree(lua_State* state, int32 index)
+{
+    return (ArgmatcherTree*)luaL_testudata(state, index, "argmatcher_tree_mt");
+}
+
+//------------------------------------------------------------------------------
+static void push_arg(lua_State* state, int32 tree_index, const ArgmatcherTree::Position& position)
+{
+    lua_getuservalue(state, tree_index);
+    lua_rawgeti(state, -1, position.node + 1);
+    lua_getfield(state, -1, "_args");
+    lua_rawgeti(state, -1, position.arg_index);
+    lua_replace(state, -4);
+    lua_pop(state, 2);
+}
+
+//------------------------------------------------------------------------------
+/// Steps the words of line_state through the compiled argmatchers and adds the
+/// choices that are known ahead of time to match_builder. Returns the Lua arg
+/// table if it has entries that need Lua to generate them (or nil), the value
+/// that the generator should return, and if flags were being matched. If
+/// match_builder isn't a native one (e.g. it's deferred) the choices are not
+/// added but returned as a fourth value instead, a table of strings.
+static int32 generate(lua_State* state)
+{
+    auto* self = check_tree(state, 1);
+    auto* line_state = LineStateLua::check(state, 2);
+    if (self == nullptr || line_state == nullptr)
+        return 0;
+
+    const LineState& line = line_state->get_line_state();
+    auto* builder_lua = MatchBuilderLua::check(state, 3);
+
+    ArgmatcherTree::Position position = self->walk(line);
+
+    // Select between adding flags or matches themselves. Works in conjunction
+    // with getprefixlength()'s return.
+    StrIter end_word = line.get_end_word();
+    int32 flags = self->get_flags(position.node);
+    bool is_flags = (flags >= 0);
+    is_flags = is_flags && self->is_flag(position.node, end_word.get_pointer(), end_word.length());
+
+    ArgmatcherTree::Position add_position = position;
+    if (is_flags)
+    {
+        add_position = { uint32(flags), 1 };
+        if (builder_lua != nullptr)
+            builder_lua->get_builder().set_prefix_included();
+    }
+
+    bool dynamic;
+    int32 choices_index = 0;
+    if (builder_lua != nullptr)
+        dynamic = self->add_matches(add_position, builder_lua->get_builder());
+    else
+    {
+        dynamic = self->push_matches(add_position, state);
+        choices_index = lua_gettop(state);
+    }
+
+    if (dynamic)
+        push_arg(state, 1, add_position);
+    else
+        lua_pushnil(state);
+
+    // With no valid argument decide if we should match files or not.
+    bool ret = (!is_flags && self->has_arg(position)) || !self->has_files(position.node);
+    lua_pushboolean(state, ret);
+    lua_pushboolean(state, is_flags);
+
+    if (!choices_index)
+        return 3;
+
+    lua_pushvalue(state, choices_index);
+    return 4;
+}
+
+//------------------------------------------------------------------------------
+/// -name:  clink._compileargmatcher
+/// -arg:   argmatcher:table
+/// -ret:   userdata
+/// Compiles an argmatcher and all the argmatchers reachable from it in to a
+/// tree that line states can be stepped through natively.
+static int32 compile_argmatcher(lua_State* state)
+{
+    if (!lua_istable(state, 1))
+        return 0;
+
+    void* user_data = lua_newuserdata(state, sizeof(ArgmatcherTree));
+    auto* self = new (user_data) ArgmatcherTree();
+
+    if (luaL_newmetatable(state, "argmatcher_tree_mt"))
+    {
+        lua_createtable(state, 0, 0);
+        lua_pushliteral(state, "generate");
+        lua_pushcfunction(state, generate);
+        lua_rawset(state, -3);
+        lua_setfield(state, -2, "__index");
+
+        auto gc_thunk = [] (lua_State* state) -> int32 {
+            auto* self = (ArgmatcherTree*)lua_touserdata(state, 1);
+            self->~ArgmatcherTree();
+            return 0;
+        };
+        lua_pushcfunction(state, gc_thunk);
+        lua_setfield(state, -2, "__gc");
+    }
+
+    lua_setmetatable(state, -2);
+
+    // The tree's nodes map back to their matchers' tables via the uservalue.
+    lua_createtable(state, 0, 0);
+    self->compile(state, 1, -1);
+    lua_setuservalue(state, -2);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+void argmatcher_lua_initialise(LuaState& lua)
+{
+    struct {
+        const char* name;
+        int32       (*method)(lua_State*);
+    } methods[] = {
+        { "_compileargmatcher", &compile_argmatcher },
+    };
+
+    lua_State* state = lua.get_state();
+
+    lua_getglobal(state, "clink");
+
+    for (const auto& method : methods)
+    {
+        lua_pushstring(state, method.name);
+        lua_pushcfunction(state, method.method);
+        lua_rawset(state, -3);
+    }
+
+    lua_pop(state, 1);
+}
@@ -0,0 +1,78 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <vector>
+
+class LineState;
+class MatchBuilder;
+struct lua_State;
+
+//------------------------------------------------------------------------------
+// A flattened, read-only copy of a graph of argmatchers defined in Lua. Words
+// are stepped through it natively instead of walking the Lua tables. Choices
+// are held as ids into InternedStrings so they can be added as matches as is.
+class ArgmatcherTree
+{
+public:
+    struct Position
+    {
+        uint32              node;
+        int32               arg_index;
+    };
+
+    bool                    compile(lua_State* state, int32 root_index, int32 nodes_index);
+    Position                walk(const LineState& line) const;
+    bool                    is_flag(uint32 node, const char* word, uint32 length) const;
+    int32                   get_flags(uint32 node) const;
+    bool                    has_arg(const Position& position) const;
+    bool                    has_files(uint32 node) const;
+    bool                    add_matches(const Position& position, MatchBuilder& builder) const;
+    bool                    push_matches(const Position& position, lua_State* state) const;
+
+private:
+    struct Node
+    {
+        uint32              arg_begin;
+        uint32              arg_count;
+        bool                looped;
+        bool                no_files;
+        int32               loop;
+        int32               flags;
+        char                flag_prefix[8];
+    };
+
+    struct Arg
+    {
+        uint32              choice_begin;
+        uint32              link_begin;
+        uint32              choice_count;
+        uint32              link_count;
+        bool                dynamic;
+    };
+
+    struct Link
+    {
+        uint32              hash;
+        uint32              key;
+        uint32              node;
+    };
+
+    struct Walker
+    {
+        void                push(uint32 node);
+        bool                pop();
+        std::vector<Position> stack;
+        Position            current;
+    };
+
+    static uint32           hash(const char* str, uint32 length);
+    int32                   compile_node(lua_State* state, int32 index, int32 lookup_index, int32 nodes_index);
+    void                    step(Walker& walker, const char* word, uint32 length) const;
+    const Link*             find_link(const Arg& arg, const char* word, uint32 length) const;
+    std::vector<Node>       _nodes;
+    std::vector<Arg>        _args;
+    std::vector<uint32>     _choices;
+    std::vector<Link>       _links;
+};
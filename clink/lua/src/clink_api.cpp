@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "lua_state.h"
+#include "script_stats.h"
 
 #include <core/base.h>
 #include <core/path.h>
@@ -50,6 +51,39 @@ static int32 get_screen_info(lua_State* state)
     return 1;
 }
 
+//------------------------------------------------------------------------------
+/// -name:  clink.clock
+/// -ret:   number
+/// Returns a high resolution, monotonic time in seconds. Only the difference
+/// between two times is meaningful.
+static int32 get_clock(lua_State* state)
+{
+    LARGE_INTEGER counter, freq;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&freq);
+    lua_pushnumber(state, lua_Number(double(counter.QuadPart) / double(freq.QuadPart)));
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// clink._recordtiming(name, seconds)
+static int32 record_timing(lua_State* state)
+{
+    const char* name = luaL_checkstring(state, 1);
+    double seconds = double(luaL_checknumber(state, 2));
+    ScriptStats::get().record(name, seconds);
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// clink._isskipped(name) -> boolean
+static int32 is_skipped(lua_State* state)
+{
+    const char* name = luaL_checkstring(state, 1);
+    lua_pushboolean(state, ScriptStats::get().is_skipped(name));
+    return 1;
+}
+
 //------------------------------------------------------------------------------
 void clink_lua_initialise(LuaState& lua)
 {
@@ -60,6 +94,9 @@ void clink_lua_initialise(LuaState& lua)
 // TODO : move this somewhere else.
         { "getscreeninfo",  &get_screen_info },
 //
+        { "clock",          &get_clock },
+        { "_recordtiming",  &record_timing },
+        { "_isskipped",     &is_skipped },
     };
 
     lua_State* state = lua.get_state();
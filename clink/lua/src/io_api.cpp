@@ -287,15 +287,489 @@ int32 Popen2Lua::write(lua_State* state)
 
 
 //------------------------------------------------------------------------------
-/// -name:  io.popen2
-/// -arg:   command:string
+class AsyncReader
+    : public HandleIo
+{
+public:
+                        AsyncReader(HANDLE h);
+                        ~AsyncReader();
+    bool                get(uint32 index, int32& c) const;
+    uint32              get_available() const;
+    bool                is_full() const;
+    bool                is_eof() const;
+    bool                is_ready();
+    bool                pump(DWORD timeout);
+    HANDLE              get_event() const;
+    void                copy(luaL_Buffer& out, uint32 size);
+    void                skip(uint32 size);
+    void                cancel();
+
+    static const uint32 BUFFER_SIZE = 16384;
+
+private:
+    void                issue();
+    bool                complete(DWORD timeout);
+    OVERLAPPED          _overlapped = {};
+    uint32              _read = 0;
+    uint32              _write = 0;
+    bool                _pending = false;
+    bool                _eof = false;
+    char                _buffer[BUFFER_SIZE];
+};
+
+//------------------------------------------------------------------------------
+AsyncReader::AsyncReader(HANDLE h)
+: HandleIo(h)
+{
+    _overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    _eof = (_overlapped.hEvent == nullptr);
+}
+
+//------------------------------------------------------------------------------
+AsyncReader::~AsyncReader()
+{
+    cancel();
+    if (_overlapped.hEvent != nullptr)
+        CloseHandle(_overlapped.hEvent);
+}
+
+//------------------------------------------------------------------------------
+void AsyncReader::cancel()
+{
+    // The buffer can't be released while the kernel may still write to it.
+    if (_pending)
+    {
+        DWORD bytes_read;
+        CancelIoEx(_handle, &_overlapped);
+        GetOverlappedResult(_handle, &_overlapped, &bytes_read, TRUE);
+        _pending = false;
+    }
+
+    close();
+    _eof = true;
+}
+
+//------------------------------------------------------------------------------
+bool AsyncReader::get(uint32 index, int32& c) const
+{
+    if (index >= get_available())
+        return false;
+
+    c = uint8(_buffer[(_read + index) & (BUFFER_SIZE - 1)]);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+uint32 AsyncReader::get_available() const
+{
+    return _write - _read;
+}
+
+//------------------------------------------------------------------------------
+bool AsyncReader::is_full() const
+{
+    return (get_available() == BUFFER_SIZE);
+}
+
+//------------------------------------------------------------------------------
+bool AsyncReader::is_eof() const
+{
+    return _eof && !_pending;
+}
+
+//------------------------------------------------------------------------------
+bool AsyncReader::is_ready()
+{
+    issue();
+    if (_pending)
+        complete(0);
+
+    return get_available() || is_eof();
+}
+
+//------------------------------------------------------------------------------
+HANDLE AsyncReader::get_event() const
+{
+    return _pending ? _overlapped.hEvent : nullptr;
+}
+
+//------------------------------------------------------------------------------
+void AsyncReader::copy(luaL_Buffer& out, uint32 size)
+{
+    size = min(size, get_available());
+    while (size)
+    {
+        uint32 offset = _read & (BUFFER_SIZE - 1);
+        uint32 chunk = min(size, BUFFER_SIZE - offset);
+        luaL_addlstring(&out, _buffer + offset, chunk);
+        _read += chunk;
+        size -= chunk;
+    }
+
+    issue();
+}
+
+//------------------------------------------------------------------------------
+void AsyncReader::skip(uint32 size)
+{
+    _read += min(size, get_available());
+    issue();
+}
+
+//------------------------------------------------------------------------------
+void AsyncReader::issue()
+{
+    if (_pending || _eof || is_full())
+        return;
+
+    // Read into the contiguous free space after the write cursor.
+    uint32 offset = _write & (BUFFER_SIZE - 1);
+    uint32 size = min(BUFFER_SIZE - get_available(), BUFFER_SIZE - offset);
+
+    ResetEvent(_overlapped.hEvent);
+    if (ReadFile(_handle, _buffer + offset, DWORD(size), nullptr, &_overlapped))
+        _pending = true;
+    else if (GetLastError() == ERROR_IO_PENDING)
+        _pending = true;
+    else
+        _eof = true;
+}
+
+//------------------------------------------------------------------------------
+bool AsyncReader::complete(DWORD timeout)
+{
+    if (WaitForSingleObject(_overlapped.hEvent, timeout) != WAIT_OBJECT_0)
+        return false;
+
+    _pending = false;
+
+    DWORD bytes_read = 0;
+    if (!GetOverlappedResult(_handle, &_overlapped, &bytes_read, FALSE))
+        _eof = true;
+
+    _write += bytes_read;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool AsyncReader::pump(DWORD timeout)
+{
+    issue();
+    if (!_pending)
+        return false;
+
+    if (!complete(timeout))
+        return false;
+
+    issue();
+    return true;
+}
+
+
+
+//------------------------------------------------------------------------------
+class Deadline
+{
+public:
+                    Deadline(DWORD timeout) : _timeout(timeout), _start(GetTickCount()) {}
+    DWORD           get_remaining() const;
+
+private:
+    DWORD           _timeout;
+    DWORD           _start;
+};
+
+//------------------------------------------------------------------------------
+DWORD Deadline::get_remaining() const
+{
+    if (_timeout == INFINITE)
+        return INFINITE;
+
+    DWORD elapsed = GetTickCount() - _start;
+    return (elapsed < _timeout) ? (_timeout - elapsed) : 0;
+}
+
+
+
+//------------------------------------------------------------------------------
+class Popen2AsyncLua
+{
+public:
+                    Popen2AsyncLua(HANDLE job, HANDLE read, HANDLE write);
+                    ~Popen2AsyncLua();
+    int32           read(lua_State* state);
+    int32           lines(lua_State* state);
+    int32           write(lua_State* state);
+    int32           ready(lua_State* state);
+    int32           close(lua_State* state);
+    AsyncReader&    get_reader() { return _reader; }
+
+private:
+    int32           read_line(lua_State* state, bool include_eol, DWORD timeout);
+    int32           read(lua_State* state, uint32 bytes, DWORD timeout);
+    int32           read_all(lua_State* state, DWORD timeout);
+    static DWORD    get_timeout(lua_State* state, int32 index);
+    HANDLE          _job;
+    AsyncReader     _reader;
+    HandleWriter    _writer;
+};
+
+//------------------------------------------------------------------------------
+Popen2AsyncLua::Popen2AsyncLua(HANDLE job, HANDLE read, HANDLE write)
+: _job(job)
+, _reader(read)
+, _writer(write)
+{
+}
+
+//------------------------------------------------------------------------------
+Popen2AsyncLua::~Popen2AsyncLua()
+{
+    _reader.cancel();
+    if (_job != nullptr)
+        CloseHandle(_job);
+}
+
+//------------------------------------------------------------------------------
+DWORD Popen2AsyncLua::get_timeout(lua_State* state, int32 index)
+{
+    if (!lua_isnumber(state, index))
+        return INFINITE;
+
+    int32 timeout = int32(lua_tointeger(state, index));
+    return (timeout < 0) ? INFINITE : DWORD(timeout);
+}
+
+//------------------------------------------------------------------------------
+int32 Popen2AsyncLua::read_line(lua_State* state, bool include_eol, DWORD timeout)
+{
+    // Nothing is consumed until a whole line is available so a timed out read
+    // can be retried. Lines longer than the buffer are split.
+    Deadline deadline(timeout);
+    uint32 count = 0;
+    while (true)
+    {
+        bool eol = false;
+        for (int32 c; _reader.get(count, c); )
+        {
+            ++count;
+            eol = (c == '\n');
+            if (eol)
+                break;
+        }
+
+        if (eol || _reader.is_full() || _reader.is_eof())
+            break;
+
+        if (!_reader.pump(deadline.get_remaining()) && !_reader.is_eof())
+        {
+            lua_pushnil(state);
+            lua_pushliteral(state, "timeout");
+            return 2;
+        }
+    }
+
+    if (count == 0)
+        return 0;
+
+    uint32 size = count;
+    if (!include_eol)
+    {
+        int32 c;
+        size -= _reader.get(size - 1, c) && (c == '\n');
+        size -= size && _reader.get(size - 1, c) && (c == '\r');
+    }
+
+    luaL_Buffer out;
+    luaL_buffinit(state, &out);
+    _reader.copy(out, size);
+    luaL_pushresult(&out);
+
+    _reader.skip(count - size);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+int32 Popen2AsyncLua::read(lua_State* state, uint32 bytes, DWORD timeout)
+{
+    bytes = min(bytes, AsyncReader::BUFFER_SIZE);
+
+    Deadline deadline(timeout);
+    while (_reader.get_available() < bytes && !_reader.is_eof())
+    {
+        if (!_reader.pump(deadline.get_remaining()) && !_reader.is_eof())
+        {
+            lua_pushnil(state);
+            lua_pushliteral(state, "timeout");
+            return 2;
+        }
+    }
+
+    if (!_reader.get_available())
+        return 0;
+
+    luaL_Buffer out;
+    luaL_buffinit(state, &out);
+    _reader.copy(out, bytes);
+    luaL_pushresult(&out);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+int32 Popen2AsyncLua::read_all(lua_State* state, DWORD timeout)
+{
+    // Output is streamed out of the ring buffer as it arrives. On a timeout
+    // what has been read so far is returned along with "timeout".
+    Deadline deadline(timeout);
+    luaL_Buffer out;
+    luaL_buffinit(state, &out);
+    while (true)
+    {
+        _reader.copy(out, _reader.get_available());
+        if (_reader.is_eof())
+            break;
+
+        if (!_reader.pump(deadline.get_remaining()) && !_reader.is_eof())
+        {
+            luaL_pushresult(&out);
+            lua_pushliteral(state, "timeout");
+            return 2;
+        }
+    }
+
+    luaL_pushresult(&out);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+/// -name:  popen2async:read
+/// -arg:   [format:string|integer]
+/// -arg:   [timeout:integer]
 /// -ret:   string
-static int32 popen2(lua_State* state)
+/// Reads from the child's output in the same way as io.popen2's read(). If no
+/// data arrives within 'timeout' milliseconds nil and "timeout" are returned
+/// and nothing is consumed. At most the size of the internal buffer (16KB) is
+/// returned for integer formats.
+int32 Popen2AsyncLua::read(lua_State* state)
 {
-    // Get the command line to execute.
-    if (lua_gettop(state) < 1 || !lua_isstring(state, 1))
+    DWORD timeout = get_timeout(state, 3);
+
+    if (lua_gettop(state) >= 2)
+    {
+        if (lua_isnumber(state, 2))
+        {
+            uint32 size = uint32(lua_tointeger(state, 2));
+            return read(state, size, timeout);
+        }
+
+        if (lua_isstring(state, 2))
+        {
+            const char* read_mode = lua_tostring(state, 2);
+            if (*read_mode == 'a')  return read_all(state, timeout);
+            if (*read_mode == 'l')  return read_line(state, false, timeout);
+            if (*read_mode == 'L')  return read_line(state, true, timeout);
+            return 0;
+        }
+    }
+
+    return read_line(state, false, timeout);
+}
+
+//------------------------------------------------------------------------------
+/// -name:  popen2async:lines
+/// -arg:   [timeout:integer]
+/// -ret:   function
+int32 Popen2AsyncLua::lines(lua_State* state)
+{
+    auto impl = [] (lua_State* state) -> int32 {
+        auto* self = (Popen2AsyncLua*)lua_touserdata(state, lua_upvalueindex(1));
+        DWORD timeout = get_timeout(state, lua_upvalueindex(2));
+        return self->read_line(state, false, timeout);
+    };
+
+    lua_pushvalue(state, 1);
+    lua_pushvalue(state, 2);
+    lua_pushcclosure(state, impl, 2);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+/// -name:  popen2async:write
+/// -arg:   [data:string]
+int32 Popen2AsyncLua::write(lua_State* state)
+{
+    if (!_writer.is_valid())
         return 0;
 
+    if (lua_gettop(state) < 2 || lua_isnil(state, 2))
+    {
+        _writer.close();
+        return 0;
+    }
+
+    size_t bytes;
+    const char* data = lua_tolstring(state, 2, &bytes);
+    if (data == nullptr)
+        return 0;
+
+    _writer.write(data, uint32(bytes));
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/// -name:  popen2async:ready
+/// -ret:   boolean
+/// Returns true if a read() would not need to wait; there is buffered output
+/// or the child has closed its end of the pipe.
+int32 Popen2AsyncLua::ready(lua_State* state)
+{
+    lua_pushboolean(state, _reader.is_ready());
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+/// -name:  popen2async:close
+int32 Popen2AsyncLua::close(lua_State* state)
+{
+    _reader.cancel();
+    _writer.close();
+    return 0;
+}
+
+
+
+//------------------------------------------------------------------------------
+static bool create_overlapped_pipe(HANDLE& read, HANDLE& write, SECURITY_ATTRIBUTES& sa)
+{
+    // Anonymous pipes don't support overlapped IO so a uniquely named one is
+    // used instead. Only the parent's read end is overlapped.
+    static LONG counter;
+    Wstr<64> name;
+    name.format(L"\\\\.\\pipe\\clink_popen2_%08x_%08x", GetCurrentProcessId(),
+        InterlockedIncrement(&counter));
+
+    read = CreateNamedPipeW(name.c_str(), PIPE_ACCESS_INBOUND|FILE_FLAG_OVERLAPPED,
+        PIPE_TYPE_BYTE|PIPE_WAIT, 1, 4096, 4096, 0, nullptr);
+    if (read == INVALID_HANDLE_VALUE)
+    {
+        read = nullptr;
+        return false;
+    }
+
+    write = CreateFileW(name.c_str(), GENERIC_WRITE, 0, &sa, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (write == INVALID_HANDLE_VALUE)
+    {
+        write = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static bool spawn(const char* command, bool overlapped, HANDLE& job, HANDLE& read, HANDLE& write)
+{
     // Create inheritable pipes
     union pipe_handles
     {
@@ -310,12 +784,23 @@ static int32 popen2(lua_State* state)
         HANDLE      handles[4];
     };
 
-    pipe_handles pipes;
+    pipe_handles pipes = {};
 
     SECURITY_ATTRIBUTES sa = { sizeof(sa), nullptr, TRUE };
-    for (int32 i = 0; i < sizeof_array(pipes.handles); i += 2)
-        if (!CreatePipe(&pipes.handles[i], &pipes.handles[i + 1], &sa, 0))
-            return 0;
+    if (overlapped)
+    {
+        if (!create_overlapped_pipe(pipes.stdout_read, pipes.stdout_write, sa))
+            return false;
+    }
+    else if (!CreatePipe(&pipes.stdout_read, &pipes.stdout_write, &sa, 0))
+        return false;
+
+    if (!CreatePipe(&pipes.stdin_read, &pipes.stdin_write, &sa, 0))
+        return false;
+
+    // The parent's ends mustn't be inherited or the child will never see EOF.
+    SetHandleInformation(pipes.stdout_read, HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(pipes.stdin_write, HANDLE_FLAG_INHERIT, 0);
 
     // Launch the Process.
     STARTUPINFOW si = { sizeof(si) };
@@ -326,14 +811,14 @@ static int32 popen2(lua_State* state)
 
     PROCESS_INFORMATION  pi;
     Wstr<> command_line;
-    command_line = lua_tostring(state, 1);
+    command_line = command;
     BOOL ok = CreateProcessW(nullptr, command_line.data(), nullptr, nullptr, TRUE,
         CREATE_NEW_PROCESS_GROUP|NORMAL_PRIORITY_CLASS, nullptr, nullptr, &si, &pi);
     if (ok == FALSE)
-        return 0;
+        return false;
 
     // Terminate the child's child processes.
-    HANDLE job = CreateJobObject(nullptr, nullptr);
+    job = CreateJobObject(nullptr, nullptr);
     if (job != nullptr)
     {
         JOBOBJECT_EXTENDED_LIMIT_INFORMATION limit = {};
@@ -349,12 +834,34 @@ static int32 popen2(lua_State* state)
             AssignProcessToJobObject(job, pi.hProcess);
     }
 
-    // Create the object that popen2() returns
-    void* user_data = lua_newuserdata(state, sizeof(Popen2Lua));
-    new (user_data) Popen2Lua(job, pipes.stdout_read, pipes.stdin_write);
+    read = pipes.stdout_read;
+    write = pipes.stdin_write;
     pipes.stdout_read = nullptr;
     pipes.stdin_write = nullptr;
 
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// -name:  io.popen2
+/// -arg:   command:string
+/// -ret:   string
+static int32 popen2(lua_State* state)
+{
+    // Get the command line to execute.
+    if (lua_gettop(state) < 1 || !lua_isstring(state, 1))
+        return 0;
+
+    HANDLE job, read, write;
+    if (!spawn(lua_tostring(state, 1), false, job, read, write))
+        return 0;
+
+    // Create the object that popen2() returns
+    void* user_data = lua_newuserdata(state, sizeof(Popen2Lua));
+    new (user_data) Popen2Lua(job, read, write);
+
     if (luaL_newmetatable(state, "popen2_mt"))
     {
         lua_createtable(state, 0, 0);
@@ -385,12 +892,128 @@ static int32 popen2(lua_State* state)
     }
 
     lua_setmetatable(state, -2);
+    return 1;
+}
 
-    CloseHandle(pi.hThread);
-    CloseHandle(pi.hProcess);
+//------------------------------------------------------------------------------
+/// -name:  io.popen2async
+/// -arg:   command:string
+/// -ret:   popen2async
+/// Like io.popen2() but reads from the child never block indefinitely. Reads
+/// take an optional timeout and io.waitany() can wait on several children at
+/// once. Output is buffered in a fixed-size ring buffer as it arrives.
+static int32 popen2async(lua_State* state)
+{
+    if (lua_gettop(state) < 1 || !lua_isstring(state, 1))
+        return 0;
+
+    HANDLE job, read, write;
+    if (!spawn(lua_tostring(state, 1), true, job, read, write))
+        return 0;
+
+    void* user_data = lua_newuserdata(state, sizeof(Popen2AsyncLua));
+    new (user_data) Popen2AsyncLua(job, read, write);
+
+    if (luaL_newmetatable(state, "popen2async_mt"))
+    {
+        lua_createtable(state, 0, 0);
+
+        #define BIND_METHOD(name) do {                                  \
+                auto name##_thunk = [] (lua_State* state) -> int32 {      \
+                    auto* self = (Popen2AsyncLua*)lua_touserdata(state, 1); \
+                    return self ? self->name(state) : 0;                \
+                };                                                      \
+                lua_pushliteral(state, #name);                          \
+                lua_pushcfunction(state, name##_thunk);                 \
+                lua_rawset(state, -3);                                  \
+            } while (false)
+        BIND_METHOD(read);
+        BIND_METHOD(lines);
+        BIND_METHOD(write);
+        BIND_METHOD(ready);
+        BIND_METHOD(close);
+        #undef BIND_METHOD
+
+        lua_setfield(state, -2, "__index");
+
+        auto gc_thunk = [] (lua_State* state) -> int32 {
+            auto* self = (Popen2AsyncLua*)lua_touserdata(state, 1);
+            self->~Popen2AsyncLua();
+            return 0;
+        };
+        lua_pushcfunction(state, gc_thunk);
+        lua_setfield(state, -2, "__gc");
+    }
+
+    lua_setmetatable(state, -2);
     return 1;
 }
 
+//------------------------------------------------------------------------------
+/// -name:  io.waitany
+/// -arg:   handles...:popen2async
+/// -arg:   [timeout:integer]
+/// -ret:   integer
+/// Waits until one of the given io.popen2async() handles is ready to be read
+/// from and returns its index, or nil if 'timeout' milliseconds pass first.
+static int32 wait_any(lua_State* state)
+{
+    int32 count = lua_gettop(state);
+    DWORD timeout = INFINITE;
+    if (count > 0 && lua_isnumber(state, count))
+    {
+        int32 value = int32(lua_tointeger(state, count));
+        timeout = (value < 0) ? INFINITE : DWORD(value);
+        --count;
+    }
+
+    count = min(count, int32(MAXIMUM_WAIT_OBJECTS));
+
+    Deadline deadline(timeout);
+    while (true)
+    {
+        HANDLE events[MAXIMUM_WAIT_OBJECTS];
+        int32 indices[MAXIMUM_WAIT_OBJECTS];
+        DWORD event_count = 0;
+
+        for (int32 i = 1; i <= count; ++i)
+        {
+            auto* self = (Popen2AsyncLua*)luaL_testudata(state, i, "popen2async_mt");
+            if (self == nullptr)
+                continue;
+
+            AsyncReader& reader = self->get_reader();
+            if (reader.is_ready())
+            {
+                lua_pushinteger(state, i);
+                return 1;
+            }
+
+            if (HANDLE event = reader.get_event())
+            {
+                events[event_count] = event;
+                indices[event_count] = i;
+                ++event_count;
+            }
+        }
+
+        if (!event_count)
+            return 0;
+
+        DWORD ret = WaitForMultipleObjects(event_count, events, FALSE, deadline.get_remaining());
+        if (ret >= WAIT_OBJECT_0 + event_count)
+            return 0;
+
+        // A completed read may have been empty so go round again to check.
+        auto* self = (Popen2AsyncLua*)lua_touserdata(state, indices[ret - WAIT_OBJECT_0]);
+        if (self->get_reader().is_ready())
+        {
+            lua_pushinteger(state, indices[ret - WAIT_OBJECT_0]);
+            return 1;
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 void io_lua_initialise(LuaState& lua)
 {
@@ -398,7 +1021,9 @@ void io_lua_initialise(LuaState& lua)
         const char* name;
         int32       (*method)(lua_State*);
     } methods[] = {
-        { "popen2", &popen2 },
+        { "popen2",         &popen2 },
+        { "popen2async",    &popen2async },
+        { "waitany",        &wait_any },
     };
 
     lua_State* state = lua.get_state();
@@ -14,6 +14,7 @@ class LineStateLua
 {
 public:
                         LineStateLua(const LineState& line);
+    const LineState&    get_line_state() const { return _line; }
     int32               get_line(lua_State* state);
     int32               get_cursor(lua_State* state);
     int32               get_command_offset(lua_State* state);
@@ -26,6 +26,8 @@ public:
                         LuaBindable(const char* name, const Method* methods);
                         ~LuaBindable();
     void                push(lua_State* state);
+    void                rebind(lua_State* state, int32 index);
+    static T*           check(lua_State* state, int32 index);
 
 private:
     static int32        call(lua_State* state);
@@ -87,6 +89,10 @@ void LuaBindable<T>::bind()
         }
 
         lua_setfield(_state, -2, "__index");
+
+        // Tags the metatable so check() can tell our userdata from others'.
+        lua_pushlightuserdata(_state, (void*)&LuaBindable<T>::call);
+        lua_setfield(_state, -2, "__bindable");
     }
 
     lua_setmetatable(_state, -2);
@@ -122,6 +128,41 @@ void LuaBindable<T>::push(lua_State* state)
     lua_rawgeti(_state, LUA_REGISTRYINDEX, _registry_ref);
 }
 
+//------------------------------------------------------------------------------
+// Points a userdata that was pushed for an earlier object of the same type at
+// this one instead, so Lua code still holding it sees this object. Pushing
+// this object afterwards pushes that userdata.
+template <class T>
+void LuaBindable<T>::rebind(lua_State* state, int32 index)
+{
+    unbind();
+
+    void* self = lua_touserdata(state, index);
+    if (self == nullptr)
+        return;
+
+    *(void**)self = this;
+
+    lua_pushvalue(state, index);
+    _state = state;
+    _registry_ref = luaL_ref(state, LUA_REGISTRYINDEX);
+}
+
+//------------------------------------------------------------------------------
+template <class T>
+T* LuaBindable<T>::check(lua_State* state, int32 index)
+{
+    auto* const* self = (T* const*)lua_touserdata(state, index);
+    if (self == nullptr || !lua_getmetatable(state, index))
+        return nullptr;
+
+    lua_getfield(state, -1, "__bindable");
+    bool ok = (lua_touserdata(state, -1) == (void*)&LuaBindable<T>::call);
+    lua_pop(state, 2);
+
+    return ok ? *self : nullptr;
+}
+
 //------------------------------------------------------------------------------
 template <class T>
 int32 LuaBindable<T>::call(lua_State* state)
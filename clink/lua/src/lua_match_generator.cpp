@@ -9,6 +9,7 @@
 #include "line_state_lua.h"
 #include "match_builder_lua.h"
 
+#include <core/trace.h>
 #include <lib/line_state.h>
 #include <lib/matches.h>
 
@@ -21,6 +22,8 @@ extern "C" {
 //------------------------------------------------------------------------------
 LuaMatchGenerator::LuaMatchGenerator(LuaState& state)
 : _state(state)
+, _line_ref(LUA_NOREF)
+, _builder_ref(LUA_NOREF)
 {
     lua_load_script(_state, lib, generator);
     lua_load_script(_state, lib, arguments);
@@ -29,6 +32,7 @@ LuaMatchGenerator::LuaMatchGenerator(LuaState& state)
 //------------------------------------------------------------------------------
 LuaMatchGenerator::~LuaMatchGenerator()
 {
+    release_pending();
 }
 
 //------------------------------------------------------------------------------
@@ -40,38 +44,109 @@ void LuaMatchGenerator::print_error(const char* error) const
 
 //------------------------------------------------------------------------------
 bool LuaMatchGenerator::generate(const LineState& line, MatchBuilder& Builder)
+{
+    TRACE_SCOPE("Lua: clink._generate");
+
+    // Generators still suspended from the last line are abandoned.
+    release_pending();
+    return call("_generate", line, Builder);
+}
+
+//------------------------------------------------------------------------------
+bool LuaMatchGenerator::resume(const LineState& line, MatchBuilder& Builder)
+{
+    TRACE_SCOPE("Lua: clink._resume_generators");
+
+    if (!_pending)
+        return false;
+
+    return call("_resume_generators", line, Builder);
+}
+
+//------------------------------------------------------------------------------
+bool LuaMatchGenerator::is_pending() const
+{
+    return _pending;
+}
+
+//------------------------------------------------------------------------------
+bool LuaMatchGenerator::call(const char* name, const LineState& line, MatchBuilder& Builder)
 {
     lua_State* state = _state.get_state();
 
     // Call to Lua to generate matches.
     lua_getglobal(state, "clink");
-    lua_pushliteral(state, "_generate");
+    lua_pushstring(state, name);
     lua_rawget(state, -2);
 
+    // Suspended generators hold on to the line state and builder they were
+    // started with, so those are pointed at the current ones.
     LineStateLua line_lua(line);
-    line_lua.push(state);
-
     MatchBuilderLua builder_lua(Builder);
-    builder_lua.push(state);
+    if (_pending)
+    {
+        lua_rawgeti(state, LUA_REGISTRYINDEX, _line_ref);
+        line_lua.rebind(state, -1);
+
+        lua_rawgeti(state, LUA_REGISTRYINDEX, _builder_ref);
+        builder_lua.rebind(state, -1);
+    }
+    else
+    {
+        line_lua.push(state);
+        builder_lua.push(state);
+    }
 
-    if (lua_pcall(state, 2, 1, 0) != 0)
+    if (lua_pcall(state, 2, 2, 0) != 0)
     {
         if (const char* error = lua_tostring(state, -1))
             print_error(error);
 
         lua_settop(state, 0);
+        release_pending();
         return false;
     }
 
-    int32 use_matches = lua_toboolean(state, -1);
+    int32 use_matches = lua_toboolean(state, -2);
+    bool pending = !!lua_toboolean(state, -1);
     lua_settop(state, 0);
 
+    if (pending && !_pending)
+    {
+        line_lua.push(state);
+        _line_ref = luaL_ref(state, LUA_REGISTRYINDEX);
+
+        builder_lua.push(state);
+        _builder_ref = luaL_ref(state, LUA_REGISTRYINDEX);
+
+        _pending = true;
+    }
+    else if (!pending)
+        release_pending();
+
     return !!use_matches;
 }
 
+//------------------------------------------------------------------------------
+void LuaMatchGenerator::release_pending()
+{
+    if (!_pending)
+        return;
+
+    lua_State* state = _state.get_state();
+    luaL_unref(state, LUA_REGISTRYINDEX, _line_ref);
+    luaL_unref(state, LUA_REGISTRYINDEX, _builder_ref);
+
+    _line_ref = LUA_NOREF;
+    _builder_ref = LUA_NOREF;
+    _pending = false;
+}
+
 //------------------------------------------------------------------------------
 int32 LuaMatchGenerator::get_prefix_length(const LineState& line) const
 {
+    TRACE_SCOPE("Lua: clink._get_prefix_length");
+
     lua_State* state = _state.get_state();
 
     // Call to Lua to calculate prefix length.
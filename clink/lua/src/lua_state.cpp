@@ -32,6 +32,7 @@ static SettingStr g_lua_path(
 
 
 //------------------------------------------------------------------------------
+void argmatcher_lua_initialise(LuaState&);
 void clink_lua_initialise(LuaState&);
 void io_lua_initialise(LuaState&);
 void os_lua_initialise(LuaState&);
@@ -91,6 +92,7 @@ void LuaState::initialise()
         lua_load_script(self, lib, debugger);
 
     clink_lua_initialise(self);
+    argmatcher_lua_initialise(self);
     io_lua_initialise(self);
     os_lua_initialise(self);
     path_lua_initialise(self);
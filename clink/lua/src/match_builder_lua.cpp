@@ -60,11 +60,13 @@ int32 MatchBuilderLua::set_prefix_included(lua_State* state)
 
 //------------------------------------------------------------------------------
 /// -name:  Builder:addmatches
-/// -arg:   matches:table or function
+/// -arg:   matches:table, function, or string
 /// -ret:   integer, boolean
 /// This is the equivalent of calling Builder:addmatch() in a for-loop. Returns
 /// the number of matches added and a boolean indicating if all matches were
 /// added successfully. If matches is a function is called until it returns nil.
+/// If matches is a string it is treated as a newline-separated list of matches,
+/// which is the quickest way to add very large numbers of plain matches.
 int32 MatchBuilderLua::add_matches(lua_State* state)
 {
     int32 count = 0;
@@ -74,6 +76,7 @@ int32 MatchBuilderLua::add_matches(lua_State* state)
     {
         if (lua_istable(state, 1))
         {
+            // Only the sequence 1..n holds matches, and in that order.
             total = int32(lua_rawlen(state, 1));
             for (int32 i = 1; i <= total; ++i)
             {
@@ -82,6 +85,32 @@ int32 MatchBuilderLua::add_matches(lua_State* state)
                 lua_pop(state, 1);
             }
         }
+        else if (lua_type(state, 1) == LUA_TSTRING)
+        {
+            size_t length;
+            const char* packed = lua_tolstring(state, 1, &length);
+            const char* end = packed + length;
+
+            total = 0;
+            while (packed < end)
+            {
+                const char* eol = (const char*)memchr(packed, '\n', end - packed);
+                const char* next = (eol != nullptr) ? eol + 1 : end;
+                if (eol == nullptr)
+                    eol = end;
+
+                if (eol > packed && eol[-1] == '\r')
+                    --eol;
+
+                if (eol > packed)
+                {
+                    count += !!_builder.add_match(packed, uint32(eol - packed));
+                    ++total;
+                }
+
+                packed = next;
+            }
+        }
         else if (lua_isfunction(state, 1))
         {
             for (total = 0;; ++total)
@@ -95,8 +124,6 @@ int32 MatchBuilderLua::add_matches(lua_State* state)
                 lua_pop(state, 1);
             }
         }
-
-        return 2;
     }
 
     lua_pushinteger(state, count);
@@ -109,8 +136,9 @@ bool MatchBuilderLua::add_match_impl(lua_State* state, int32 stack_index)
 {
     if (lua_isstring(state, stack_index))
     {
-        const char* match = lua_tostring(state, stack_index);
-        return _builder.add_match(match);
+        size_t length;
+        const char* match = lua_tolstring(state, stack_index, &length);
+        return _builder.add_match(match, uint32(length));
     }
     else if (lua_istable(state, stack_index))
     {
@@ -15,6 +15,7 @@ class MatchBuilderLua
 public:
                     MatchBuilderLua(MatchBuilder& Builder);
                     ~MatchBuilderLua();
+    MatchBuilder&   get_builder() const { return _builder; }
     int32           add_match(lua_State* state);
     int32           add_matches(lua_State* state);
     int32           set_prefix_included(lua_State* state);
@@ -0,0 +1,149 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "script_stats.h"
+
+#include <core/base.h>
+#include <core/log.h>
+#include <core/settings.h>
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+static SettingInt g_lua_budget(
+    "lua.budget",
+    "Time budget for scripts (ms)",
+    "Generators and prompt filters that take longer than this many milliseconds\n"
+    "to run are logged. A value of 0 disables the budget.",
+    100);
+
+static SettingInt g_lua_skip_after(
+    "lua.skip_after",
+    "Skip generators after overruns",
+    "A generator or prompt filter that overruns 'lua.budget' this many times in\n"
+    "a row is skipped until Clink is restarted. A value of 0 never skips them.",
+    3);
+
+
+
+//------------------------------------------------------------------------------
+double ScriptStats::Entry::get_mean() const
+{
+    return count ? (total / count) : 0.0;
+}
+
+//------------------------------------------------------------------------------
+double ScriptStats::Entry::get_p99() const
+{
+    uint32 n = min<uint32>(count, sample_count);
+    if (!n)
+        return 0.0;
+
+    float sorted[sample_count];
+    memcpy(sorted, samples, sizeof(float) * n);
+    std::sort(sorted, sorted + n);
+    return sorted[((n * 99) + 99) / 100 - 1];
+}
+
+
+
+//------------------------------------------------------------------------------
+ScriptStats& ScriptStats::get()
+{
+    static ScriptStats instance;
+    return instance;
+}
+
+//------------------------------------------------------------------------------
+void ScriptStats::record(const char* name, double seconds)
+{
+    auto* entry = const_cast<Entry*>(find(name));
+    if (entry == nullptr)
+    {
+        _entries.emplace_back();
+        entry = &_entries.back();
+        entry->name = name;
+    }
+
+    entry->samples[entry->count % Entry::sample_count] = float(seconds);
+    entry->total += seconds;
+    ++entry->count;
+    _dirty = true;
+
+    int32 budget = g_lua_budget.get();
+    if (budget <= 0 || seconds * 1000.0 <= budget)
+    {
+        entry->overruns = 0;
+        return;
+    }
+
+    ++entry->overruns;
+    WARN("Script '%s' took %.1f ms (budget %d ms)", name, seconds * 1000.0, budget);
+
+    int32 skip_after = g_lua_skip_after.get();
+    if (skip_after > 0 && entry->overruns >= uint32(skip_after) && !entry->skipped)
+    {
+        entry->skipped = true;
+        WARN("Skipping script '%s' after %d overruns", name, entry->overruns);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ScriptStats::is_skipped(const char* name) const
+{
+    const Entry* entry = find(name);
+    return (entry != nullptr && entry->skipped);
+}
+
+//------------------------------------------------------------------------------
+uint32 ScriptStats::get_count() const
+{
+    return uint32(_entries.size());
+}
+
+//------------------------------------------------------------------------------
+const ScriptStats::Entry& ScriptStats::get_entry(uint32 index) const
+{
+    return _entries[index];
+}
+
+//------------------------------------------------------------------------------
+bool ScriptStats::save(const char* path)
+{
+    if (!_dirty)
+        return true;
+
+    FILE* out = fopen(path, "wt");
+    if (out == nullptr)
+        return false;
+
+    fprintf(out, "%8s %10s %10s  %s\n", "count", "mean_ms", "p99_ms", "script");
+    for (const Entry& entry : _entries)
+    {
+        fprintf(out, "%8u %10.2f %10.2f  %s%s\n", entry.count,
+            entry.get_mean() * 1000.0, entry.get_p99() * 1000.0,
+            entry.name.c_str(), entry.skipped ? " (skipped)" : "");
+    }
+
+    fclose(out);
+    _dirty = false;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ScriptStats::reset()
+{
+    _entries.clear();
+    _dirty = false;
+}
+
+//------------------------------------------------------------------------------
+const ScriptStats::Entry* ScriptStats::find(const char* name) const
+{
+    for (const Entry& entry : _entries)
+        if (entry.name.equals(name))
+            return &entry;
+
+    return nullptr;
+}
@@ -0,0 +1,193 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include "line_editor_tester.h"
+
+#include <lua/lua_match_generator.h>
+#include <lua/lua_state.h>
+#include <lua/script_stats.h>
+
+//------------------------------------------------------------------------------
+TEST_CASE("Lua yielding generators")
+{
+    LuaState lua;
+    LuaMatchGenerator lua_generator(lua);
+
+    LineEditorTester tester;
+    tester.get_editor()->add_generator(lua_generator);
+
+    const char* script = "\
+        local a = clink.generator(1)\
+        function a:generate(line_state, match_builder)\
+            match_builder:addmatch('abc')\
+            coroutine.yield()\
+            match_builder:addmatch('abd')\
+            return line_state:getline() == 'abc'\
+        end\
+        \
+        local b = clink.generator(2)\
+        function b:generate(line_state, match_builder)\
+            match_builder:addmatch('abce')\
+            if match_builder:addmatches('abch\\nabci\\r\\n') ~= 2 then\
+                match_builder:addmatch('ab_fail')\
+            end\
+            coroutine.yield()\
+            match_builder:addmatches({ 'abcf' })\
+            return true\
+        end\
+        \
+        local c = clink.generator(3)\
+        function c:generate(line_state, match_builder)\
+            match_builder:addmatch('abg')\
+            return true\
+        end\
+    ";
+
+    REQUIRE(lua.do_string(script));
+
+    SECTION("Resumed")
+    {
+        tester.set_input("ab");
+        tester.set_expected_matches("abc", "abd", "abce", "abcf", "abch", "abci");
+        tester.run();
+    }
+
+    SECTION("Claimed")
+    {
+        tester.set_input("abc");
+        tester.set_expected_matches("abc");
+        tester.run();
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Lua generators yielding userdata")
+{
+    LuaState lua;
+    LuaMatchGenerator lua_generator(lua);
+
+    LineEditorTester tester;
+    tester.get_editor()->add_generator(lua_generator);
+
+    // Builder methods are userdata that can't be indexed. Anything other than
+    // an io.popen2async() handle is resumed as if nothing was yielded.
+    const char* script = "\
+        local a = clink.generator(1)\
+        function a:generate(line_state, match_builder)\
+            coroutine.yield(match_builder.addmatch)\
+            coroutine.yield(io.stdout)\
+            match_builder:addmatch('abc')\
+            return true\
+        end\
+    ";
+
+    REQUIRE(lua.do_string(script));
+
+    tester.set_input("ab");
+    tester.set_expected_matches("abc");
+    tester.run();
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Lua yielding generators and argmatchers")
+{
+    LuaState lua;
+    LuaMatchGenerator lua_generator(lua);
+
+    LineEditorTester tester;
+    tester.get_editor()->add_generator(lua_generator);
+
+    // The argmatcher generator starts while 'a' is suspended, so its builder
+    // is a deferred one.
+    const char* script = "\
+        local a = clink.generator(1)\
+        function a:generate(line_state, match_builder)\
+            coroutine.yield()\
+            return false\
+        end\
+        \
+        local r = clink.argmatcher():addarg('four', 'five')\
+        clink.argmatcher('argcmd')\
+            :addarg('one', 'two' .. r)\
+            :addflags('-flag', '-flog')\
+    ";
+
+    REQUIRE(lua.do_string(script));
+
+    SECTION("Args")
+    {
+        tester.set_input("argcmd ");
+        tester.set_expected_matches("one", "two");
+        tester.run();
+    }
+
+    SECTION("Linked")
+    {
+        tester.set_input("argcmd two f");
+        tester.set_expected_matches("four", "five");
+        tester.run();
+    }
+
+    SECTION("Flags")
+    {
+        tester.set_input("argcmd -fl");
+        tester.set_expected_matches("-flag", "-flog");
+        tester.run();
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Lua slow generators")
+{
+    LuaState lua;
+    LuaMatchGenerator lua_generator(lua);
+
+    LineEditorTester tester;
+    tester.get_editor()->add_generator(lua_generator);
+
+    const char* script = "\
+        local a = clink.generator(1)\
+        a._name = 'lua_test_slow'\
+        function a:generate(line_state, match_builder)\
+            match_builder:addmatch('abc')\
+        end\
+        \
+        local b = clink.generator(2)\
+        function b:generate(line_state, match_builder)\
+            match_builder:addmatch('abd')\
+        end\
+    ";
+
+    REQUIRE(lua.do_string(script));
+
+    // Stats are process-wide, so each run starts (and leaves them) empty.
+    ScriptStats::get().reset();
+
+    SECTION("Timed")
+    {
+        REQUIRE(lua.do_string("assert(clink.clock() <= clink.clock())"));
+
+        tester.set_input("ab");
+        tester.set_expected_matches("abc", "abd");
+        tester.run();
+
+        REQUIRE(!ScriptStats::get().is_skipped("lua_test_slow"));
+    }
+
+    SECTION("Skipped")
+    {
+        // Overrunning the budget enough times in a row skips the generator.
+        for (int32 i = 0; i < 3; ++i)
+            ScriptStats::get().record("lua_test_slow", 10.0);
+
+        REQUIRE(ScriptStats::get().is_skipped("lua_test_slow"));
+
+        tester.set_input("ab");
+        tester.set_expected_matches("abd");
+        tester.run();
+    }
+
+    ScriptStats::get().reset();
+}
@@ -0,0 +1,87 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include "line_editor_tester.h"
+
+#include <lua/lua_match_generator.h>
+#include <lua/lua_state.h>
+
+//------------------------------------------------------------------------------
+TEST_CASE("Lua match builder")
+{
+    LuaState lua;
+    LuaMatchGenerator lua_generator(lua);
+
+    LineEditorTester tester;
+    tester.get_editor()->add_generator(lua_generator);
+
+    SECTION("Table")
+    {
+        const char* script = "\
+            local g = clink.generator(1)\
+            function g:generate(line_state, match_builder)\
+                local count, all = match_builder:addmatches({\
+                    'abc', 'abd', { match = 'abe' }, key = 'abf',\
+                    [1.5] = 'abg', [-3] = 'abh'\
+                })\
+                if count ~= 3 or not all then\
+                    match_builder:addmatch('ab_fail')\
+                end\
+                return true\
+            end\
+        ";
+
+        REQUIRE(lua.do_string(script));
+
+        tester.set_input("ab");
+        tester.set_expected_matches("abc", "abd", "abe");
+        tester.run();
+    }
+
+    SECTION("Packed string")
+    {
+        const char* script = "\
+            local g = clink.generator(1)\
+            function g:generate(line_state, match_builder)\
+                local count, all = match_builder:addmatches('abc\\nabd\\r\\n\\nabe')\
+                if count ~= 3 or not all then\
+                    match_builder:addmatch('ab_fail')\
+                end\
+                return true\
+            end\
+        ";
+
+        REQUIRE(lua.do_string(script));
+
+        tester.set_input("ab");
+        tester.set_expected_matches("abc", "abd", "abe");
+        tester.run();
+    }
+
+    SECTION("Function")
+    {
+        const char* script = "\
+            local g = clink.generator(1)\
+            function g:generate(line_state, match_builder)\
+                local i = 0\
+                local matches = { 'abc', 'abd' }\
+                local count, all = match_builder:addmatches(function()\
+                    i = i + 1\
+                    return matches[i]\
+                end)\
+                if count ~= 2 or not all then\
+                    match_builder:addmatch('ab_fail')\
+                end\
+                return true\
+            end\
+        ";
+
+        REQUIRE(lua.do_string(script));
+
+        tester.set_input("ab");
+        tester.set_expected_matches("abc", "abd");
+        tester.run();
+    }
+}
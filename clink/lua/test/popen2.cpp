@@ -218,3 +218,57 @@ TEST_CASE("Lua io.popen2 - write")
     REQUIRE(lua_gettop(state) == 2);
     lua_pop(state, 2);
 }
+
+//------------------------------------------------------------------------------
+TEST_CASE("Lua io.popen2async")
+{
+    LuaState lua;
+
+    const char* script = "\
+        slow = io.popen2async('cmd.exe /c ping -n 3 127.0.0.1 >nul&echo late')\
+        fast = io.popen2async('cmd.exe /c echo one&echo two')\
+    ";
+    REQUIRE(lua.do_string(script));
+
+    SECTION("Timeout")
+    {
+        const char* script = "\
+            local ret, err = slow:read('l', 10)\
+            assert(ret == nil and err == 'timeout')\
+            assert(slow:read('l') == 'late')\
+            assert(slow:read('l', 10) == nil)\
+        ";
+        REQUIRE(lua.do_string(script));
+    }
+
+    SECTION("Wait any")
+    {
+        const char* script = "\
+            assert(io.waitany(slow, fast) == 2)\
+            assert(fast:ready())\
+            assert(not slow:ready())\
+            assert(io.waitany(slow, 10) == nil)\
+        ";
+        REQUIRE(lua.do_string(script));
+    }
+
+    SECTION("Lines")
+    {
+        const char* script = "\
+            local out = {}\
+            for line in fast:lines(1000) do table.insert(out, line) end\
+            assert(#out == 2 and out[1] == 'one' and out[2] == 'two')\
+        ";
+        REQUIRE(lua.do_string(script));
+    }
+
+    SECTION("Read all")
+    {
+        const char* script = "\
+            assert(fast:read('a') == 'one\\r\\ntwo\\r\\n')\
+            slow:close()\
+            assert(slow:ready())\
+        ";
+        REQUIRE(lua.do_string(script));
+    }
+}
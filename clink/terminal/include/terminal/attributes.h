@@ -50,6 +50,7 @@ public:
 
         bool                    operator == (const Colour& rhs) const { return value == rhs.value; }
         void                    as_888(uint8 (&out)[3]) const;
+        uint8                   as_16() const;
     };
 
     template <typename T>
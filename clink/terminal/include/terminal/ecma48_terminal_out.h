@@ -16,7 +16,7 @@ public:
                         Ecma48TerminalOut(ScreenBuffer& screen);
     virtual void        begin() override;
     virtual void        end() override;
-    virtual void        write(const char* chars, int32 length) override;
+    virtual int32       write(const char* chars, int32 length) override;
     virtual void        flush() override;
     virtual int32       get_columns() const override;
     virtual int32       get_rows() const override;
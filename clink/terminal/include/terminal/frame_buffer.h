@@ -0,0 +1,30 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+//------------------------------------------------------------------------------
+// Accumulates UTF-8 output as UTF-16 so a whole frame of writes can be handed
+// to the console in as few calls as possible.
+class FrameBuffer
+{
+public:
+                    FrameBuffer() = default;
+                    FrameBuffer(const FrameBuffer&) = delete;
+                    ~FrameBuffer();
+    int32           append(const char* data, int32 length);
+    uint32          flush(void* handle);
+    const wchar_t*  get_data() const    { return _data; }
+    uint32          get_length() const  { return _length; }
+    bool            empty() const       { return _length == 0; }
+    void            clear()             { _length = 0; }
+    void            operator = (const FrameBuffer&) = delete;
+    static uint32   get_chunk_length(const wchar_t* data, uint32 remaining);
+    static const uint32 flush_size = 0x4000;
+
+private:
+    bool            reserve(uint32 size);
+    wchar_t*        _data = nullptr;
+    uint32          _size = 0;
+    uint32          _length = 0;
+};
@@ -0,0 +1,53 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include "screen_buffer.h"
+#include "screen_grid.h"
+
+class StrBase;
+
+//------------------------------------------------------------------------------
+// A screen buffer that only exists in memory. Useful as a backend where there
+// isn't a console, such as when testing. It also counts what is drawn to it so
+// the cost of rendering can be measured.
+class HeadlessScreenBuffer
+    : public ScreenBuffer
+{
+public:
+    struct Stats
+    {
+        uint32          bytes;
+        uint32          writes;
+        uint32          cursor_moves;
+        uint32          flushes;
+    };
+
+                        HeadlessScreenBuffer(int32 columns=80, int32 rows=25);
+    void                resize(int32 columns, int32 rows);
+    const ScreenGrid&   get_grid() const    { return _grid; }
+    const Stats&        get_stats() const   { return _stats; }
+    void                reset_stats()       { _stats = {}; }
+    void                get_row(int32 row, StrBase& out) const;
+    void                snapshot(StrBase& out) const;
+    bool                compare(const char* expected) const;
+    virtual void        begin() override    {}
+    virtual void        end() override      {}
+    virtual int32       write(const char* data, int32 length) override;
+    virtual void        flush() override    { ++_stats.flushes; }
+    virtual int32       get_columns() const override;
+    virtual int32       get_rows() const override;
+    virtual void        get_cursor(int32& column, int32& row) const override;
+    virtual void        clear(ClearType type) override;
+    virtual void        clear_line(ClearType type) override;
+    virtual void        set_cursor(int32 column, int32 row) override;
+    virtual void        move_cursor(int32 dx, int32 dy) override;
+    virtual void        insert_chars(int32 count) override;
+    virtual void        delete_chars(int32 count) override;
+    virtual void        set_attributes(const Attributes attr) override;
+
+protected:
+    ScreenGrid          _grid;
+    Stats               _stats = {};
+};
@@ -19,10 +19,11 @@ public:
     virtual         ~ScreenBuffer() = default;
     virtual void    begin() = 0;
     virtual void    end() = 0;
-    virtual void    write(const char* data, int32 length) = 0;
+    virtual int32   write(const char* data, int32 length) = 0;
     virtual void    flush() = 0;
     virtual int32   get_columns() const = 0;
     virtual int32   get_rows() const = 0;
+    virtual void    get_cursor(int32& column, int32& row) const = 0;
     virtual void    clear(ClearType Type) = 0;
     virtual void    clear_line(ClearType Type) = 0;
     virtual void    set_cursor(int32 column, int32 row) = 0;
@@ -0,0 +1,61 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include "attributes.h"
+#include "screen_buffer.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// An in-memory model of a console's window. It follows the same rules as the
+// Windows console does; writes wrap at the end of a row, line feeds also return
+// the cursor, and writing past the bottom row scrolls the grid up.
+class ScreenGrid
+{
+public:
+    struct Cell
+    {
+        bool                operator == (const Cell& rhs) const;
+        bool                operator != (const Cell& rhs) const { return !(*this == rhs); }
+        uint32              c;          // 0 if nothing is known about the cell.
+        uint8               width;      // 0 for the right half of a wide character.
+        Attributes          attr;
+    };
+
+    typedef ScreenBuffer::ClearType ClearType;
+
+                            ScreenGrid(int32 columns=80, int32 rows=25);
+    void                    resize(int32 columns, int32 rows);
+    void                    reset(uint32 c=0);
+    int32                   write(const char* data, int32 length);
+    void                    clear(ClearType type);
+    void                    clear_line(ClearType type);
+    void                    set_cursor(int32 column, int32 row);
+    void                    move_cursor(int32 dx, int32 dy);
+    void                    insert_chars(int32 count);
+    void                    delete_chars(int32 count);
+    void                    set_attributes(const Attributes attr);
+    void                    scroll(int32 count);
+    int32                   take_scroll_count();
+    const Cell&             get_cell(int32 column, int32 row) const;
+    Cell&                   get_cell(int32 column, int32 row);
+    Attributes              get_attributes() const  { return _attr; }
+    int32                   get_columns() const     { return _columns; }
+    int32                   get_rows() const        { return _rows; }
+    int32                   get_cursor_column() const { return _cursor_x; }
+    int32                   get_cursor_row() const  { return _cursor_y; }
+
+private:
+    void                    put(uint32 c);
+    void                    line_feed();
+    void                    fill(int32 column, int32 row, int32 count);
+    std::vector<Cell>       _cells;
+    Attributes              _attr;
+    int32                   _columns = 0;
+    int32                   _rows = 0;
+    int32                   _cursor_x = 0;
+    int32                   _cursor_y = 0;
+    int32                   _scroll_count = 0;
+};
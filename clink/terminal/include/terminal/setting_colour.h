@@ -33,6 +33,20 @@ public:
     Attributes          get() const;
 
 private:
+    // Accepts the named colours and also 0-255 for xterm's palette and #rrggbb.
+    class Value
+        : public SettingEnum
+    {
+    public:
+                        Value(const char* name, const char* short_desc, const char* long_desc, const char* values, int32 default_value);
+        virtual bool    set(const char* value) override;
+        virtual void    get(StrBase& out) const override;
+        using           SettingEnum::get;
+
+    private:
+        bool            set_value(int32 value);
+    };
+
     template <class T, bool AUTO_DTOR=true>
     struct Late
     {
@@ -45,6 +59,9 @@ private:
         align_to(8)     char buffer[sizeof(T)];
     };
 
-    Late<SettingEnum>   _fg;
-    Late<SettingEnum>   _bg;
+    Late<Value>         _fg;
+    Late<Value>         _bg;
+    mutable Attributes  _attr;
+    mutable uint32      _fg_generation = ~0u;
+    mutable uint32      _bg_generation = ~0u;
 };
@@ -17,6 +17,7 @@ public:
     virtual         ~TerminalIn() = default;
     virtual void    begin() = 0;
     virtual void    end() = 0;
-    virtual void    select() = 0;
+    virtual void    select(int32 timeout=-1) = 0;
+    virtual bool    has_input() const = 0;
     virtual int32   read() = 0;
 };
@@ -0,0 +1,49 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include "screen_buffer.h"
+#include "screen_grid.h"
+
+//------------------------------------------------------------------------------
+// Draws into a grid of cells instead of directly to another screen buffer. On
+// flush() the grid is compared with what was last drawn and only the cells that
+// have changed are written to the target, along with the cursor moves needed
+// to get to them.
+class VirtualScreenBuffer
+    : public ScreenBuffer
+{
+public:
+                    VirtualScreenBuffer(ScreenBuffer& target);
+    virtual void    begin() override;
+    virtual void    end() override;
+    virtual int32   write(const char* data, int32 length) override;
+    virtual void    flush() override;
+    virtual int32   get_columns() const override;
+    virtual int32   get_rows() const override;
+    virtual void    get_cursor(int32& column, int32& row) const override;
+    virtual void    clear(ClearType type) override;
+    virtual void    clear_line(ClearType type) override;
+    virtual void    set_cursor(int32 column, int32 row) override;
+    virtual void    move_cursor(int32 dx, int32 dy) override;
+    virtual void    insert_chars(int32 count) override;
+    virtual void    delete_chars(int32 count) override;
+    virtual void    set_attributes(const Attributes attr) override;
+
+private:
+    void            render();
+    void            render_scroll();
+    bool            is_dirty(int32 column, int32 row) const;
+    int32           find_run_end(int32 column, int32 row) const;
+    void            emit_run(int32 column, int32 end, int32 row);
+    void            emit_cursor(int32 column, int32 row);
+    void            emit_attributes(const Attributes attr);
+    ScreenBuffer&   _target;
+    ScreenGrid      _front;
+    ScreenGrid      _back;
+    Attributes      _attr;
+    int32           _cursor_x = 0;
+    int32           _cursor_y = 0;
+    bool            _attr_valid = false;
+};
@@ -0,0 +1,26 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <core/base.h>
+
+#include <stddef.h>
+
+extern "C" int32    wcwidth(int32 c);
+extern "C" int32    wcswidth(const wchar_t* ptr, size_t size);
+
+//------------------------------------------------------------------------------
+// Measures a sequence of code points in cells the way terminals draw emoji; a
+// ZWJ sequence or an emoji with a skin tone occupies one wide cell, and VS16
+// widens the character before it to emoji presentation.
+class ClusterWidth
+{
+public:
+    int32               next(int32 c);
+    void                reset();
+
+private:
+    int32               _width = 0;
+    bool                _join = false;
+};
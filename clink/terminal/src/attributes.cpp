@@ -14,12 +14,107 @@ enum
 
 
 
+//------------------------------------------------------------------------------
+static const uint8 g_basic_888[16][3] = {
+    {   0,   0,   0 }, { 128,   0,   0 }, {   0, 128,   0 }, { 128, 128,   0 },
+    {   0,   0, 128 }, { 128,   0, 128 }, {   0, 128, 128 }, { 192, 192, 192 },
+    { 128, 128, 128 }, { 255,   0,   0 }, {   0, 255,   0 }, { 255, 255,   0 },
+    {   0,   0, 255 }, { 255,   0, 255 }, {   0, 255, 255 }, { 255, 255, 255 },
+};
+
+//------------------------------------------------------------------------------
+// Finds the closest of the sixteen basic colours to every 5:5:5 RGB value and
+// every entry in xterm's 256 colour palette. It is built once on first use so
+// that quantizing a colour is only ever a lookup.
+struct NearestTable
+{
+                NearestTable();
+    static uint8 find(const uint8 (&rgb)[3]);
+    uint8       from_555[1 << 15];
+    uint8       from_256[256];
+};
+
+//------------------------------------------------------------------------------
+NearestTable::NearestTable()
+{
+    Attributes::Colour colour;
+    uint8 rgb[3];
+
+    for (int32 i = 0; i < sizeof_array(from_256); ++i)
+    {
+        colour.value = uint16(i);
+        colour.as_888(rgb);
+        from_256[i] = (i < 16) ? uint8(i) : find(rgb);
+    }
+
+    for (int32 i = 0; i < sizeof_array(from_555); ++i)
+    {
+        colour.value = uint16(i);
+        colour.is_rgb = 1;
+        colour.as_888(rgb);
+        from_555[i] = find(rgb);
+    }
+}
+
+//------------------------------------------------------------------------------
+uint8 NearestTable::find(const uint8 (&rgb)[3])
+{
+    // Weighted to roughly follow the eye's sensitivity to each channel.
+    uint8 best = 0;
+    int32 best_distance = INT_MAX;
+    for (int32 i = 0; i < sizeof_array(g_basic_888); ++i)
+    {
+        int32 dr = rgb[0] - g_basic_888[i][0];
+        int32 dg = rgb[1] - g_basic_888[i][1];
+        int32 db = rgb[2] - g_basic_888[i][2];
+        int32 distance = (dr * dr * 3) + (dg * dg * 4) + (db * db * 2);
+        if (distance < best_distance)
+        {
+            best = uint8(i);
+            best_distance = distance;
+        }
+    }
+
+    return best;
+}
+
+
+
 //------------------------------------------------------------------------------
 void Attributes::Colour::as_888(uint8 (&out)[3]) const
 {
-    out[0] = (r << 3) | (r & 7);
-    out[1] = (g << 3) | (g & 7);
-    out[2] = (b << 3) | (b & 7);
+    if (is_rgb)
+    {
+        out[0] = (r << 3) | (r & 7);
+        out[1] = (g << 3) | (g & 7);
+        out[2] = (b << 3) | (b & 7);
+        return;
+    }
+
+    // xterm's 256 colour palette; the basic colours, a 6x6x6 cube, and greys.
+    uint8 index = uint8(value);
+    if (index < 16)
+    {
+        for (int32 i = 0; i < 3; ++i)
+            out[i] = g_basic_888[index][i];
+    }
+    else if (index < 232)
+    {
+        static const uint8 levels[] = { 0, 95, 135, 175, 215, 255 };
+        index -= 16;
+        out[0] = levels[index / 36];
+        out[1] = levels[(index / 6) % 6];
+        out[2] = levels[index % 6];
+    }
+    else
+        out[0] = out[1] = out[2] = uint8(8 + ((index - 232) * 10));
+}
+
+//------------------------------------------------------------------------------
+uint8 Attributes::Colour::as_16() const
+{
+    static const NearestTable table;
+    return is_rgb ? table.from_555[value & 0x7fff] : table.from_256[value & 0xff];
 }
 
 
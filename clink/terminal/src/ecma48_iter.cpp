@@ -3,41 +3,149 @@
 
 #include "pch.h"
 #include "ecma48_iter.h"
+#include "wcwidth.h"
 
 #include <core/base.h>
 #include <core/str_tokeniser.h>
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#   define ECMA48_SSE2
+#   include <emmintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   endif
+#endif
+
+//------------------------------------------------------------------------------
+static bool in_range(int32 value, int32 left, int32 right)
+{
+    return (uint32(right - value) <= uint32(right - left));
+}
+
+#if defined(ECMA48_SSE2)
+//------------------------------------------------------------------------------
+// Block tests set a bit for each byte in 'data' that a scan should stop at.
+static uint32 test_c0(__m128i data)
+{
+    const __m128i c0_max = _mm_set1_epi8(0x1f);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(data, c0_max), data));
+}
+
+//------------------------------------------------------------------------------
+static uint32 test_not_ascii(__m128i data)
+{
+    // The comparison is signed so bytes >= 0x80 are never greater than 0x1f.
+    __m128i printable = _mm_cmpgt_epi8(data, _mm_set1_epi8(0x1f));
+    __m128i del = _mm_cmpeq_epi8(data, _mm_set1_epi8(0x7f));
+    return ~_mm_movemask_epi8(_mm_andnot_si128(del, printable)) & 0xffff;
+}
+
+//------------------------------------------------------------------------------
+template <uint32 (*TEST)(__m128i)>
+static const char* find_block(const char* ptr, const char* end)
+{
+    // Aligned loads never straddle a page so reading either side of the string
+    // is safe. Bytes before 'ptr' are masked off.
+    uint32 misalign = uint32(uintptr_t(ptr) & 15);
+    const char* block = ptr - misalign;
+    uint32 mask = ~0u << misalign;
+    while (true)
+    {
+        __m128i data = _mm_load_si128((const __m128i*)block);
+        if (uint32 bits = TEST(data) & mask)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, bits);
+#else
+            uint32 index = __builtin_ctz(bits);
+#endif
+            const char* ret = block + index;
+            return (end != nullptr && ret > end) ? end : ret;
+        }
+
+        block += 16;
+        mask = ~0u;
+        if (end != nullptr && block >= end)
+            return end;
+    }
+}
+#endif // ECMA48_SSE2
+
+//------------------------------------------------------------------------------
+// Finds the first C0 control byte (which includes ESC and the nul terminator)
+// at or after 'ptr'. If 'end' is not null then the search stops there.
+static const char* find_c0(const char* ptr, const char* end)
+{
+#if defined(ECMA48_SSE2)
+    return find_block<test_c0>(ptr, end);
+#else
+    for (; end == nullptr || ptr < end; ++ptr)
+        if (uint8(*ptr) < 0x20)
+            break;
+
+    return ptr;
+#endif
+}
+
 //------------------------------------------------------------------------------
-extern "C" int32 wcwidth(int32);
+// As find_c0() but finds the first byte that isn't printable ASCII.
+static const char* find_not_ascii(const char* ptr, const char* end)
+{
+#if defined(ECMA48_SSE2)
+    return find_block<test_not_ascii>(ptr, end);
+#else
+    for (; end == nullptr || ptr < end; ++ptr)
+        if (uint8(*ptr - 0x20) >= 0x5f)
+            break;
+
+    return ptr;
+#endif
+}
 
 
 
 //------------------------------------------------------------------------------
 uint32 cell_count(const char* in)
 {
-    uint32 count = 0;
+    // Most strings are plain ASCII where each byte is a cell.
+    const char* ascii_end = find_not_ascii(in, nullptr);
+    uint32 count = uint32(ascii_end - in);
+    if (*ascii_end == '\0')
+        return count;
+
+    ClusterWidth cluster;
+    if (count)
+        cluster.next(ascii_end[-1]);
 
     Ecma48State state;
-    Ecma48Iter iter(in, state);
+    Ecma48Iter iter(ascii_end, state);
     while (const Ecma48Code& code = iter.next())
     {
         if (code.get_type() != Ecma48Code::type_chars)
             continue;
 
+        // Spans of ASCII are counted as is and only what's between them is
+        // decoded and measured.
         StrIter inner_iter(code.get_pointer(), code.get_length());
-        while (int32 c = inner_iter.next())
-            count += wcwidth(c);
+        while (inner_iter.more())
+        {
+            const char* ptr = inner_iter.get_pointer();
+            if (uint32 n = uint32(find_not_ascii(ptr, inner_iter.get_end()) - ptr))
+            {
+                // Clusters only need to see the last of the span.
+                count += n - 1 + cluster.next(ptr[n - 1]);
+                inner_iter.advance(n);
+            }
+
+            while (inner_iter.more() && uint8(*inner_iter.get_pointer() - 0x20) >= 0x5f)
+                count += cluster.next(inner_iter.next());
+        }
     }
 
     return count;
 }
 
-//------------------------------------------------------------------------------
-static bool in_range(int32 value, int32 left, int32 right)
-{
-    return (uint32(right - value) <= uint32(right - left));
-}
-
 
 
 //------------------------------------------------------------------------------
@@ -241,7 +349,23 @@ bool Ecma48Iter::next_char(int32 c)
         return true;
     }
 
-    _iter.next();
+    // Only a C0 control can end a run of characters so the whole run is found
+    // in one go rather than decoding it a code point at a time.
+    const char* ptr = _iter.get_pointer();
+    const char* end = find_c0(ptr, _iter.get_end());
+
+    // Codes' lengths are 16 bits. Long runs are split at a code point boundary.
+    if (end - _code._str > 0xffff)
+    {
+        for (end = _code._str + 0xffff; end > ptr && (*end & 0xc0) == 0x80; --end);
+        if (end <= ptr)
+        {
+            _code._type = Ecma48Code::type_chars;
+            return true;
+        }
+    }
+
+    _iter.advance(uint32(end - ptr));
     return false;
 }
 
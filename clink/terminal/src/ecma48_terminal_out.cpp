@@ -6,6 +6,8 @@
 #include "ecma48_iter.h"
 #include "screen_buffer.h"
 
+#include <core/trace.h>
+
 //------------------------------------------------------------------------------
 Ecma48TerminalOut::Ecma48TerminalOut(ScreenBuffer& screen)
 : _screen(screen)
@@ -27,6 +29,7 @@ void Ecma48TerminalOut::end()
 //------------------------------------------------------------------------------
 void Ecma48TerminalOut::flush()
 {
+    TRACE_SCOPE("TerminalOut::flush");
     _screen.flush();
 }
 
@@ -106,15 +109,16 @@ void Ecma48TerminalOut::write_c0(int32 c0)
 }
 
 //------------------------------------------------------------------------------
-void Ecma48TerminalOut::write(const char* chars, int32 length)
+int32 Ecma48TerminalOut::write(const char* chars, int32 length)
 {
+    int32 written = 0;
     Ecma48Iter iter(chars, _state, length);
     while (const Ecma48Code& code = iter.next())
     {
         switch (code.get_type())
         {
         case Ecma48Code::type_chars:
-            _screen.write(code.get_pointer(), code.get_length());
+            written += _screen.write(code.get_pointer(), code.get_length());
             break;
 
         case Ecma48Code::type_c0:
@@ -126,6 +130,8 @@ void Ecma48TerminalOut::write(const char* chars, int32 length)
             break;
         }
     }
+
+    return written;
 }
 
 //------------------------------------------------------------------------------
@@ -174,7 +180,33 @@ void Ecma48TerminalOut::set_attributes(const Ecma48Code::CsiBase& csi)
             continue;
         }
 
-        // TODO: Rgb/xterm256 support for terminals that support it.
+        // Extended colours; 38;5;n from xterm's palette or 38;2;r;g;b. Anything
+        // malformed leaves the remaining parameters ambiguous so stops parsing.
+        if ((param == 38) | (param == 48))
+        {
+            bool fg = (param == 38);
+            int32 type = csi.get_param(i + 1);
+            if (type == 5 && i + 2 < csi.param_count)
+            {
+                uint8 index = uint8(clamp(csi.params[i + 2], 0, 255));
+                fg ? attr.set_fg(index) : attr.set_bg(index);
+                i += 2;
+                continue;
+            }
+
+            if (type == 2 && i + 4 < csi.param_count)
+            {
+                uint8 rgb[3];
+                for (int32 j = 0; j < 3; ++j)
+                    rgb[j] = uint8(clamp(csi.params[i + 2 + j], 0, 255));
+
+                fg ? attr.set_fg(rgb[0], rgb[1], rgb[2]) : attr.set_bg(rgb[0], rgb[1], rgb[2]);
+                i += 4;
+                continue;
+            }
+
+            break;
+        }
     }
 
     _screen.set_attributes(attr);
@@ -0,0 +1,87 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "frame_buffer.h"
+
+#include <core/base.h>
+#include <core/str.h>
+#include <core/str_iter.h>
+
+#include <Windows.h>
+
+//------------------------------------------------------------------------------
+FrameBuffer::~FrameBuffer()
+{
+    free(_data);
+}
+
+//------------------------------------------------------------------------------
+bool FrameBuffer::reserve(uint32 size)
+{
+    if (size <= _size)
+        return true;
+
+    uint32 new_size = max<uint32>(_size * 2, 1024);
+    new_size = max(new_size, size);
+
+    auto* data = (wchar_t*)realloc(_data, new_size * sizeof(wchar_t));
+    if (data == nullptr)
+        return false;
+
+    _data = data;
+    _size = new_size;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+int32 FrameBuffer::append(const char* data, int32 length)
+{
+    if (length < 0)
+        length = int32(strlen(data));
+
+    if (length == 0)
+        return 0;
+
+    // A UTF-8 sequence never encodes to more UTF-16 units than it has bytes.
+    if (!reserve(_length + length + 1))
+        return 0;
+
+    StrIter iter(data, length);
+    _length += to_utf16(_data + _length, length + 1, iter);
+    return length;
+}
+
+//------------------------------------------------------------------------------
+// Chunks are at most 'flush_size' long and don't end between the two halves of
+// a surrogate pair, which the console would draw as two bad characters.
+uint32 FrameBuffer::get_chunk_length(const wchar_t* data, uint32 remaining)
+{
+    uint32 n = min<uint32>(remaining, flush_size);
+    if (n < remaining && n > 1 && (data[n - 1] & 0xfc00) == 0xd800)
+        --n;
+
+    return n;
+}
+
+//------------------------------------------------------------------------------
+uint32 FrameBuffer::flush(void* handle)
+{
+    // Large frames are split as old consoles have a limit on a single write.
+    uint32 total = 0;
+    const wchar_t* data = _data;
+    for (uint32 remaining = _length; remaining; )
+    {
+        DWORD written = 0;
+        DWORD n = get_chunk_length(data, remaining);
+        if (!WriteConsoleW(handle, data, n, &written, nullptr) || !written)
+            break;
+
+        data += written;
+        remaining -= written;
+        total += written;
+    }
+
+    _length = 0;
+    return total;
+}
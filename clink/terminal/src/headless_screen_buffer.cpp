@@ -0,0 +1,158 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "headless_screen_buffer.h"
+
+#include <core/base.h>
+#include <core/str.h>
+
+//------------------------------------------------------------------------------
+HeadlessScreenBuffer::HeadlessScreenBuffer(int32 columns, int32 rows)
+: _grid(columns, rows)
+{
+    _grid.reset(' ');
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::resize(int32 columns, int32 rows)
+{
+    _grid.resize(columns, rows);
+}
+
+//------------------------------------------------------------------------------
+int32 HeadlessScreenBuffer::write(const char* data, int32 length)
+{
+    int32 written = _grid.write(data, length);
+    _stats.bytes += written;
+    ++_stats.writes;
+    return written;
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::get_row(int32 row, StrBase& out) const
+{
+    out.clear();
+    if (row < 0 || row >= _grid.get_rows())
+        return;
+
+    // Trailing blanks are trimmed. Cells that have never been drawn to are
+    // shown as '?'.
+    char utf8[8];
+    int32 trimmed_length = 0;
+    for (int32 x = 0, n = _grid.get_columns(); x < n; ++x)
+    {
+        const ScreenGrid::Cell& cell = _grid.get_cell(x, row);
+        if (!cell.width)
+            continue;
+
+        wchar_t wc[3] = { wchar_t(cell.c ? cell.c : '?') };
+        if (cell.c > 0xffff)
+        {
+            wc[0] = wchar_t((cell.c >> 10) + 0xd7c0);
+            wc[1] = wchar_t((cell.c & 0x3ff) + 0xdc00);
+        }
+
+        int32 utf8_length = to_utf8(utf8, sizeof_array(utf8), wc);
+        out.concat(utf8, utf8_length);
+
+        if (cell.c != ' ')
+            trimmed_length = out.length();
+    }
+
+    out.truncate(trimmed_length);
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::snapshot(StrBase& out) const
+{
+    // Rows are separated by new lines and empty rows at the end are dropped.
+    out.clear();
+
+    Str<256> row;
+    int32 trimmed_length = 0;
+    for (int32 y = 0, n = _grid.get_rows(); y < n; ++y)
+    {
+        if (y)
+            out << "\n";
+
+        get_row(y, row);
+        out << row;
+
+        if (!row.empty())
+            trimmed_length = out.length();
+    }
+
+    out.truncate(trimmed_length);
+}
+
+//------------------------------------------------------------------------------
+bool HeadlessScreenBuffer::compare(const char* expected) const
+{
+    Str<1024> out;
+    snapshot(out);
+    return out.equals(expected);
+}
+
+//------------------------------------------------------------------------------
+int32 HeadlessScreenBuffer::get_columns() const
+{
+    return _grid.get_columns();
+}
+
+//------------------------------------------------------------------------------
+int32 HeadlessScreenBuffer::get_rows() const
+{
+    return _grid.get_rows();
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::get_cursor(int32& column, int32& row) const
+{
+    column = _grid.get_cursor_column();
+    row = _grid.get_cursor_row();
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::clear(ClearType type)
+{
+    _grid.clear(type);
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::clear_line(ClearType type)
+{
+    _grid.clear_line(type);
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::set_cursor(int32 column, int32 row)
+{
+    ++_stats.cursor_moves;
+    _grid.set_cursor(column, row);
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::move_cursor(int32 dx, int32 dy)
+{
+    ++_stats.cursor_moves;
+    _grid.move_cursor(dx, dy);
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::insert_chars(int32 count)
+{
+    _grid.insert_chars(count);
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::delete_chars(int32 count)
+{
+    _grid.delete_chars(count);
+}
+
+//------------------------------------------------------------------------------
+void HeadlessScreenBuffer::set_attributes(const Attributes attr)
+{
+    _grid.set_attributes(attr);
+}
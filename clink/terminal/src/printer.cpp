@@ -67,6 +67,21 @@ void Printer::flush_attributes()
         params << x;
     };
 
+    // Colours outside of the basic sixteen use xterm's extended forms.
+    auto add_extended = [&] (const Attributes::Colour& colour, const char* select) {
+        Str<24, false> x;
+        if (colour.is_rgb)
+        {
+            uint8 rgb[3];
+            colour.as_888(rgb);
+            x.format("%s;2;%d;%d;%d", select, rgb[0], rgb[1], rgb[2]);
+        }
+        else
+            x.format("%s;5;%d", select, colour.value);
+
+        add_param(x.c_str());
+    };
+
     auto fg = diff.get_fg();
     auto bg = diff.get_bg();
     if (fg.is_default & bg.is_default)
@@ -77,28 +92,32 @@ void Printer::flush_attributes()
     {
         if (fg)
         {
-            if (!fg.is_default)
+            if (fg.is_default)
+                add_param("39");
+            else if (fg->is_rgb || fg->value > 15)
+                add_extended(fg.value, "38");
+            else
             {
                 char x[] = "30";
                 x[0] += (fg->value > 7) ? 6 : 0;
                 x[1] += fg->value & 0x07;
                 add_param(x);
             }
-            else
-                add_param("39");
         }
 
         if (bg)
         {
-            if (!bg.is_default)
+            if (bg.is_default)
+                add_param("49");
+            else if (bg->is_rgb || bg->value > 15)
+                add_extended(bg.value, "48");
+            else
             {
                 char x[] = "100";
                 x[1] += (bg->value > 7) ? 0 : 4;
                 x[2] += bg->value & 0x07;
                 add_param((bg->value > 7) ? x : x + 1);
             }
-            else
-                add_param("49");
         }
     }
 
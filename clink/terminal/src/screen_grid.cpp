@@ -0,0 +1,249 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "screen_grid.h"
+#include "wcwidth.h"
+
+#include <core/base.h>
+#include <core/str_iter.h>
+
+//------------------------------------------------------------------------------
+static int32 offset_clamp(int32 value, int32 delta, int32 max_value)
+{
+    int64 ret = int64(value) + delta;
+    return int32(clamp<int64>(ret, 0, max_value));
+}
+
+
+
+//------------------------------------------------------------------------------
+bool ScreenGrid::Cell::operator == (const Cell& rhs) const
+{
+    Attributes lhs_attr = attr;
+    return (c == rhs.c) && (width == rhs.width) && (lhs_attr == rhs.attr);
+}
+
+
+
+//------------------------------------------------------------------------------
+ScreenGrid::ScreenGrid(int32 columns, int32 rows)
+: _attr(Attributes::defaults)
+{
+    resize(columns, rows);
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::resize(int32 columns, int32 rows)
+{
+    columns = max(columns, 1);
+    rows = max(rows, 1);
+    if (columns == _columns && rows == _rows)
+        return;
+
+    std::vector<Cell> cells(columns * rows, Cell({ 0, 1, _attr }));
+    for (int32 y = 0, h = min(rows, _rows); y < h; ++y)
+        for (int32 x = 0, w = min(columns, _columns); x < w; ++x)
+            cells[(y * columns) + x] = get_cell(x, y);
+
+    _cells.swap(cells);
+    _columns = columns;
+    _rows = rows;
+    _cursor_x = min(_cursor_x, columns - 1);
+    _cursor_y = min(_cursor_y, rows - 1);
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::reset(uint32 c)
+{
+    for (Cell& cell : _cells)
+        cell = { c, 1, _attr };
+
+    _scroll_count = 0;
+}
+
+//------------------------------------------------------------------------------
+const ScreenGrid::Cell& ScreenGrid::get_cell(int32 column, int32 row) const
+{
+    return _cells[(row * _columns) + column];
+}
+
+//------------------------------------------------------------------------------
+ScreenGrid::Cell& ScreenGrid::get_cell(int32 column, int32 row)
+{
+    return _cells[(row * _columns) + column];
+}
+
+//------------------------------------------------------------------------------
+int32 ScreenGrid::write(const char* data, int32 length)
+{
+    StrIter iter(data, length);
+    while (int32 c = iter.next())
+    {
+        switch (c)
+        {
+        case '\n':  line_feed();                                    break;
+        case '\r':  _cursor_x = 0;                                  break;
+        case '\b':  _cursor_x = max(_cursor_x - 1, 0);              break;
+        case '\t':  do { put(' '); } while (_cursor_x & 7);         break;
+        default:    if (c >= 0x20) put(c);                          break;
+        }
+    }
+
+    return int32(iter.get_pointer() - data);
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::put(uint32 c)
+{
+    int32 width = wcwidth(c);
+    if (width <= 0)
+        return;
+
+    if (_cursor_x + width > _columns)
+        line_feed();
+
+    // Overwriting half of a wide character leaves the other half blank.
+    Cell* cell = &get_cell(_cursor_x, _cursor_y);
+    if (cell->width == 0 && _cursor_x > 0)
+        cell[-1] = { ' ', 1, cell[-1].attr };
+
+    int32 end = _cursor_x + width;
+    if (end < _columns && cell[width].width == 0)
+        cell[width] = { ' ', 1, cell[width].attr };
+
+    cell[0] = { c, uint8(width), _attr };
+    for (int32 i = 1; i < width; ++i)
+        cell[i] = { c, 0, _attr };
+
+    // Like the console, the cursor wraps as soon as the last column is used.
+    _cursor_x = end;
+    if (_cursor_x >= _columns)
+        line_feed();
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::line_feed()
+{
+    _cursor_x = 0;
+    if (_cursor_y + 1 < _rows)
+        ++_cursor_y;
+    else
+        scroll(1);
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::scroll(int32 count)
+{
+    count = min(count, _rows);
+    if (count <= 0)
+        return;
+
+    Cell* cells = _cells.data();
+    int32 moved = (_rows - count) * _columns;
+    memmove(cells, cells + (count * _columns), moved * sizeof(Cell));
+    for (int32 i = moved, n = _rows * _columns; i < n; ++i)
+        cells[i] = { ' ', 1, _attr };
+
+    _scroll_count += count;
+}
+
+//------------------------------------------------------------------------------
+int32 ScreenGrid::take_scroll_count()
+{
+    int32 ret = _scroll_count;
+    _scroll_count = 0;
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::fill(int32 column, int32 row, int32 count)
+{
+    Cell* cell = &get_cell(column, row);
+    for (int32 i = 0; i < count; ++i)
+        cell[i] = { ' ', 1, _attr };
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::clear(ClearType type)
+{
+    switch (type)
+    {
+    case ScreenBuffer::clear_type_all:
+        fill(0, 0, _columns * _rows);
+        break;
+
+    case ScreenBuffer::clear_type_before:
+        fill(0, 0, (_cursor_y * _columns) + _cursor_x + 1);
+        break;
+
+    case ScreenBuffer::clear_type_after:
+        fill(_cursor_x, _cursor_y, ((_rows - _cursor_y) * _columns) - _cursor_x);
+        break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::clear_line(ClearType type)
+{
+    switch (type)
+    {
+    case ScreenBuffer::clear_type_all:
+        fill(0, _cursor_y, _columns);
+        break;
+
+    case ScreenBuffer::clear_type_before:
+        fill(0, _cursor_y, _cursor_x + 1);
+        break;
+
+    case ScreenBuffer::clear_type_after:
+        fill(_cursor_x, _cursor_y, _columns - _cursor_x);
+        break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::set_cursor(int32 column, int32 row)
+{
+    _cursor_x = clamp(column, 0, _columns - 1);
+    _cursor_y = clamp(row, 0, _rows - 1);
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::move_cursor(int32 dx, int32 dy)
+{
+    _cursor_x = offset_clamp(_cursor_x, dx, _columns - 1);
+    _cursor_y = offset_clamp(_cursor_y, dy, _rows - 1);
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::insert_chars(int32 count)
+{
+    count = min(count, _columns - _cursor_x);
+    if (count <= 0)
+        return;
+
+    Cell* cell = &get_cell(_cursor_x, _cursor_y);
+    int32 moved = _columns - _cursor_x - count;
+    memmove(cell + count, cell, moved * sizeof(Cell));
+    fill(_cursor_x, _cursor_y, count);
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::delete_chars(int32 count)
+{
+    count = min(count, _columns - _cursor_x);
+    if (count <= 0)
+        return;
+
+    Cell* cell = &get_cell(_cursor_x, _cursor_y);
+    int32 moved = _columns - _cursor_x - count;
+    memmove(cell, cell + count, moved * sizeof(Cell));
+    fill(_cursor_x + moved, _cursor_y, count);
+}
+
+//------------------------------------------------------------------------------
+void ScreenGrid::set_attributes(const Attributes attr)
+{
+    _attr = Attributes::merge(_attr, attr);
+}
@@ -4,12 +4,90 @@
 #include "pch.h"
 #include "setting_colour.h"
 
+#include <ctype.h>
+#include <stdlib.h>
+
 //------------------------------------------------------------------------------
 #define COLOUR_X(x) #x ","
 static const char* colour_fg_values = COLOUR_XS "normal,bright,default";
 static const char* colour_bg_values = COLOUR_XS "default";
 #undef COLOUR_X
 
+//------------------------------------------------------------------------------
+// Palette and RGB values are stored above the named colours' indices.
+enum : int32
+{
+    value_palette_bit   = 0x100,
+    value_rgb_bit       = 0x1000000,
+};
+
+
+
+//------------------------------------------------------------------------------
+SettingColour::Value::Value(
+    const char* name,
+    const char* short_desc,
+    const char* long_desc,
+    const char* values,
+    int32 default_value)
+: SettingEnum(name, short_desc, long_desc, values, default_value)
+{
+}
+
+//------------------------------------------------------------------------------
+bool SettingColour::Value::set(const char* value)
+{
+    if (value[0] == '#')
+    {
+        for (int32 i = 1; i <= 6; ++i)
+            if (!isxdigit(uint8(value[i])))
+                return false;
+
+        if (value[7])
+            return false;
+
+        return set_value(value_rgb_bit | int32(strtoul(value + 1, nullptr, 16)));
+    }
+
+    if (value[0] >= '0' && value[0] <= '9')
+    {
+        char* end;
+        int32 index = int32(strtoul(value, &end, 10));
+        if (index > 255 || *end)
+            return false;
+
+        return set_value(value_palette_bit | index);
+    }
+
+    return SettingEnum::set(value);
+}
+
+//------------------------------------------------------------------------------
+bool SettingColour::Value::set_value(int32 value)
+{
+    if (_store.value != value)
+    {
+        _store.value = value;
+        changed();
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void SettingColour::Value::get(StrBase& out) const
+{
+    int32 value = _store.value;
+    if (value & value_rgb_bit)
+        out.format("#%06x", value & 0xffffff);
+    else if (value & value_palette_bit)
+        out.format("%d", value & 0xff);
+    else
+        SettingEnum::get(out);
+}
+
+
+
 //------------------------------------------------------------------------------
 SettingColour::SettingColour(
     const char* name,
@@ -40,23 +118,46 @@ SettingColour::SettingColour(
 //------------------------------------------------------------------------------
 Attributes SettingColour::get() const
 {
+    // Only work the attributes out again if the colours have changed.
+    uint32 fg_generation = _fg->get_generation();
+    uint32 bg_generation = _bg->get_generation();
+    if (fg_generation == _fg_generation && bg_generation == _bg_generation)
+        return _attr;
+
     Attributes out = Attributes::defaults;
 
     int32 fg = _fg->get();
-    switch (fg)
+    if (fg & value_rgb_bit)
+        out.set_fg(uint8(fg >> 16), uint8(fg >> 8), uint8(fg));
+    else if (fg & value_palette_bit)
+        out.set_fg(uint8(fg));
+    else
     {
-    case value_fg_normal:   out.set_bold(false);    break;
-    case value_fg_bright:   out.set_bold(true);     break;
-    case value_fg_default:  out.reset_fg();         break;
-    default:                out.set_fg(fg);         break;
+        switch (fg)
+        {
+        case value_fg_normal:   out.set_bold(false);    break;
+        case value_fg_bright:   out.set_bold(true);     break;
+        case value_fg_default:  out.reset_fg();         break;
+        default:                out.set_fg(fg);         break;
+        }
     }
 
     int32 bg = _bg->get();
-    switch (bg)
+    if (bg & value_rgb_bit)
+        out.set_bg(uint8(bg >> 16), uint8(bg >> 8), uint8(bg));
+    else if (bg & value_palette_bit)
+        out.set_bg(uint8(bg));
+    else
     {
-    case value_bg_default:  out.reset_bg();         break;
-    default:                out.set_bg(bg);         break;
+        switch (bg)
+        {
+        case value_bg_default:  out.reset_bg();         break;
+        default:                out.set_bg(bg);         break;
+        }
     }
 
+    _attr = out;
+    _fg_generation = fg_generation;
+    _bg_generation = bg_generation;
     return out;
 }
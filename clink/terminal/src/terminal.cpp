@@ -4,6 +4,7 @@
 #include "pch.h"
 #include "terminal.h"
 #include "ecma48_terminal_out.h"
+#include "virtual_screen_buffer.h"
 #include "win_screen_buffer.h"
 #include "win_terminal_in.h"
 #include "win_terminal_out.h"
@@ -16,6 +17,7 @@ struct WinVirtualTerminal
 {
     DWORD           prev_mode = ~0u;
     ScreenBuffer*   screen = nullptr;
+    ScreenBuffer*   virtual_screen = nullptr;
 };
 #endif
 
@@ -51,6 +53,10 @@ Terminal terminal_create(ScreenBuffer* screen)
             impl->screen = screen;
         }
 
+        // Draw through a virtual screen so only what changes is written.
+        screen = new VirtualScreenBuffer(*screen);
+        impl->virtual_screen = screen;
+
         terminal.out = new Ecma48TerminalOut(*screen);
     }
 
@@ -74,6 +80,9 @@ void terminal_destroy(const Terminal& terminal)
         SetConsoleMode(handle, impl->prev_mode);
     }
 
+    if (impl->virtual_screen != nullptr)
+        delete impl->virtual_screen;
+
     if (impl->screen != nullptr)
         delete impl->screen;
 
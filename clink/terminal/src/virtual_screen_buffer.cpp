@@ -0,0 +1,295 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "virtual_screen_buffer.h"
+
+#include <core/base.h>
+#include <core/str.h>
+
+//------------------------------------------------------------------------------
+enum
+{
+    // Unchanged cells are rewritten rather than moving the cursor over them if
+    // there are only a few of them; it's cheaper than a cursor move.
+    bridge_limit = 4,
+};
+
+//------------------------------------------------------------------------------
+static void append_utf8(StrBase& out, uint32 c)
+{
+    char utf8[4];
+    int32 n;
+    if (c < 0x80)           { utf8[0] = char(c); n = 1; }
+    else if (c < 0x800)     { utf8[0] = char(0xc0 | (c >> 6)); n = 2; }
+    else if (c < 0x10000)   { utf8[0] = char(0xe0 | (c >> 12)); n = 3; }
+    else                    { utf8[0] = char(0xf0 | (c >> 18)); n = 4; }
+
+    for (int32 i = n - 1; i > 0; --i, c >>= 6)
+        utf8[i] = char(0x80 | (c & 0x3f));
+
+    out.concat(utf8, n);
+}
+
+
+
+//------------------------------------------------------------------------------
+VirtualScreenBuffer::VirtualScreenBuffer(ScreenBuffer& target)
+: _target(target)
+{
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::begin()
+{
+    _target.begin();
+
+    // What's already on the screen isn't known. Only cells that get drawn to
+    // are tracked.
+    int32 columns = _target.get_columns();
+    int32 rows = _target.get_rows();
+    _front.resize(columns, rows);
+    _back.resize(columns, rows);
+    _front.reset();
+    _back.reset();
+    _front.set_attributes(Attributes::defaults);
+
+    _target.get_cursor(_cursor_x, _cursor_y);
+    _front.set_cursor(_cursor_x, _cursor_y);
+    _attr_valid = false;
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::end()
+{
+    flush();
+    _target.end();
+}
+
+//------------------------------------------------------------------------------
+int32 VirtualScreenBuffer::write(const char* data, int32 length)
+{
+    return _front.write(data, length);
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::flush()
+{
+    render();
+    _target.flush();
+}
+
+//------------------------------------------------------------------------------
+int32 VirtualScreenBuffer::get_columns() const
+{
+    return _target.get_columns();
+}
+
+//------------------------------------------------------------------------------
+int32 VirtualScreenBuffer::get_rows() const
+{
+    return _target.get_rows();
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::get_cursor(int32& column, int32& row) const
+{
+    column = _front.get_cursor_column();
+    row = _front.get_cursor_row();
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::clear(ClearType type)
+{
+    _front.clear(type);
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::clear_line(ClearType type)
+{
+    _front.clear_line(type);
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::set_cursor(int32 column, int32 row)
+{
+    _front.set_cursor(column, row);
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::move_cursor(int32 dx, int32 dy)
+{
+    _front.move_cursor(dx, dy);
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::insert_chars(int32 count)
+{
+    _front.insert_chars(count);
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::delete_chars(int32 count)
+{
+    _front.delete_chars(count);
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::set_attributes(const Attributes attr)
+{
+    _front.set_attributes(attr);
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::render()
+{
+    // If the terminal's changed size then everything known gets redrawn.
+    int32 columns = _target.get_columns();
+    int32 rows = _target.get_rows();
+    if (columns != _front.get_columns() || rows != _front.get_rows())
+    {
+        _front.resize(columns, rows);
+        _back.resize(columns, rows);
+        _back.reset();
+    }
+
+    render_scroll();
+
+    for (int32 y = 0; y < rows; ++y)
+    {
+        for (int32 x = 0; x < columns;)
+        {
+            if (!is_dirty(x, y))
+            {
+                ++x;
+                continue;
+            }
+
+            int32 end = find_run_end(x, y);
+            emit_run(x, end, y);
+            x = end;
+        }
+    }
+
+    emit_cursor(_front.get_cursor_column(), _front.get_cursor_row());
+    emit_attributes(_front.get_attributes());
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::render_scroll()
+{
+    int32 count = _front.take_scroll_count();
+    if (count <= 0)
+        return;
+
+    // Line feeds on the bottom row scroll the target in the same way.
+    int32 bottom = _back.get_rows() - 1;
+    emit_cursor(0, bottom);
+    for (int32 i = min(count, bottom + 1); i > 0; --i)
+        _target.write("\n", 1);
+
+    if (_attr_valid)
+        _back.set_attributes(_attr);
+
+    _back.scroll(count);
+    _back.take_scroll_count();
+
+    _cursor_x = 0;
+    _cursor_y = bottom;
+}
+
+//------------------------------------------------------------------------------
+bool VirtualScreenBuffer::is_dirty(int32 column, int32 row) const
+{
+    const ScreenGrid::Cell& cell = _front.get_cell(column, row);
+    if (cell.c == 0 || cell.width == 0)
+        return false;
+
+    // Writing to the bottom right cell would scroll the target.
+    int32 end = column + cell.width;
+    if (row == _front.get_rows() - 1 && end >= _front.get_columns())
+        return false;
+
+    for (int32 i = column; i < end; ++i)
+        if (_front.get_cell(i, row) != _back.get_cell(i, row))
+            return true;
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+int32 VirtualScreenBuffer::find_run_end(int32 column, int32 row) const
+{
+    Attributes attr = _front.get_cell(column, row).attr;
+    int32 columns = _front.get_columns();
+    int32 bottom = _front.get_rows() - 1;
+
+    int32 end = column;
+    for (int32 i = column; i < columns;)
+    {
+        const ScreenGrid::Cell& cell = _front.get_cell(i, row);
+        if (cell.c == 0 || cell.width == 0 || !(attr == cell.attr))
+            break;
+
+        int32 next = i + cell.width;
+        if (row == bottom && next >= columns)
+            break;
+
+        if (is_dirty(i, row))
+            end = next;
+        else if (next - end > bridge_limit)
+            break;
+
+        i = next;
+    }
+
+    return end;
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::emit_run(int32 column, int32 end, int32 row)
+{
+    Str<256> run;
+    for (int32 i = column; i < end; ++i)
+    {
+        const ScreenGrid::Cell& cell = _front.get_cell(i, row);
+        if (cell.width)
+            append_utf8(run, cell.c);
+
+        _back.get_cell(i, row) = cell;
+    }
+
+    emit_cursor(column, row);
+    emit_attributes(_front.get_cell(column, row).attr);
+    _target.write(run.c_str(), run.length());
+
+    _cursor_x = end;
+    _cursor_y = row;
+    if (_cursor_x >= _front.get_columns())
+    {
+        _cursor_x = 0;
+        ++_cursor_y;
+    }
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::emit_cursor(int32 column, int32 row)
+{
+    if (column == _cursor_x && row == _cursor_y)
+        return;
+
+    _target.set_cursor(column, row);
+    _cursor_x = column;
+    _cursor_y = row;
+}
+
+//------------------------------------------------------------------------------
+void VirtualScreenBuffer::emit_attributes(const Attributes attr)
+{
+    if (_attr_valid && _attr == attr)
+        return;
+
+    _target.set_attributes(attr);
+    _attr = attr;
+    _attr_valid = true;
+}
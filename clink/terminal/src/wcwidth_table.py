@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) Martin Ridgers
+# License: http://opensource.org/licenses/MIT
+#
+# Generates wcwidth_table.h from the Unicode database that ships with Python.
+# Rerun it (python wcwidth_table.py > wcwidth_table.h) to pick up a newer
+# version of Unicode.
+#
+# Widths are stored in a two-stage table; code points are split into pages of
+# 256, each page indexes a leaf, and identical leaves are shared. Each leaf has
+# two bits per code point; 0, 1 or 2 cells, or 3 for non-printing.
+
+import sys
+import unicodedata
+
+PAGE_BITS = 8
+PAGE_SIZE = 1 << PAGE_BITS
+CODE_POINTS = 0x110000
+
+#-------------------------------------------------------------------------------
+def get_width(c):
+    if c == 0:
+        return 0
+
+    if c < 0x20 or 0x7f <= c < 0xa0:
+        return 3
+
+    ch = chr(c)
+    cat = unicodedata.category(ch)
+
+    # Soft hyphen is Cf but is usually drawn.
+    if c == 0xad:
+        return 1
+
+    # Combining marks, formatting characters, and Hangul's medial vowels and
+    # final consonants have no width of their own.
+    if cat in ("Mn", "Me", "Cf") or c == 0x200b:
+        return 0
+    if 0x1160 <= c <= 0x11ff or 0xd7b0 <= c <= 0xd7ff:
+        return 0
+
+    # Since Unicode 9 emoji with emoji presentation are East Asian Wide.
+    if unicodedata.east_asian_width(ch) in ("W", "F"):
+        return 2
+
+    # Unassigned code points in the CJK blocks and planes default to wide.
+    if cat == "Cn":
+        for first, last in ((0x3400, 0x4dbf), (0x4e00, 0x9fff), (0xf900, 0xfaff),
+                            (0x20000, 0x2fffd), (0x30000, 0x3fffd)):
+            if first <= c <= last:
+                return 2
+
+    return 1
+
+#-------------------------------------------------------------------------------
+def main():
+    leaves = {}
+    pages = []
+    for page in range(CODE_POINTS // PAGE_SIZE):
+        base = page * PAGE_SIZE
+        packed = bytearray(PAGE_SIZE // 4)
+        for i in range(PAGE_SIZE):
+            packed[i >> 2] |= get_width(base + i) << ((i & 3) << 1)
+        pages.append(leaves.setdefault(bytes(packed), len(leaves)))
+
+    assert len(leaves) <= 256
+
+    out = sys.stdout
+    out.write("// Generated by wcwidth_table.py from Unicode %s; do not edit.\n\n" % unicodedata.unidata_version)
+    out.write("#pragma once\n\n")
+    out.write("static const int32 wcwidth_page_bits = %d;\n\n" % PAGE_BITS)
+
+    out.write("static const uint8 wcwidth_pages[%d] = {\n" % len(pages))
+    for i in range(0, len(pages), 16):
+        out.write("    " + " ".join("%3d," % x for x in pages[i:i + 16]) + "\n")
+    out.write("};\n\n")
+
+    out.write("static const uint8 wcwidth_leaves[%d][%d] = {\n" % (len(leaves), PAGE_SIZE // 4))
+    for leaf in sorted(leaves, key=leaves.get):
+        out.write("    {\n")
+        for i in range(0, len(leaf), 16):
+            out.write("        " + " ".join("0x%02x," % x for x in leaf[i:i + 16]) + "\n")
+        out.write("    },\n")
+    out.write("};\n")
+
+if __name__ == "__main__":
+    main()
@@ -5,7 +5,6 @@
 #include "win_screen_buffer.h"
 
 #include <core/base.h>
-#include <core/str_iter.h>
 
 #include <Windows.h>
 
@@ -20,12 +19,15 @@ void WinScreenBuffer::begin()
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(_handle, &csbi);
     _default_attr = csbi.wAttributes & attr_mask_all;
+    _attr = _next_attr = csbi.wAttributes;
     _bold = !!(_default_attr & attr_mask_bold);
 }
 
 //------------------------------------------------------------------------------
 void WinScreenBuffer::end()
 {
+    sync();
+
     DWORD prev_mode = _prev_mode;
     SetConsoleTextAttribute(_handle, _default_attr);
     SetConsoleMode(_handle, prev_mode);
@@ -33,27 +35,45 @@ void WinScreenBuffer::end()
 }
 
 //------------------------------------------------------------------------------
-void WinScreenBuffer::write(const char* data, int32 length)
+int32 WinScreenBuffer::write(const char* data, int32 length)
 {
-    StrIter iter(data, length);
-    while (length > 0)
-    {
-        wchar_t wbuf[384];
-        int32 n = min<int32>(sizeof_array(wbuf), length + 1);
-        n = to_utf16(wbuf, n, iter);
+    // Text is collected until something needs the console's state to be
+    // current; a change of attributes, a cursor movement, or a flush().
+    if (_next_attr != _attr)
+        sync();
 
-        DWORD written;
-        WriteConsoleW(_handle, wbuf, n, &written, nullptr);
+    int32 written = _frame.append(data, length);
+    if (_frame.get_length() >= FrameBuffer::flush_size)
+        sync();
+
+    return written;
+}
+
+//------------------------------------------------------------------------------
+void WinScreenBuffer::sync()
+{
+    if (!_frame.empty())
+    {
+        _frame.flush(_handle);
+        _dirty = true;
+    }
 
-        n = int32(iter.get_pointer() - data);
-        length -= n;
-        data += n;
+    if (_next_attr != _attr)
+    {
+        SetConsoleTextAttribute(_handle, _next_attr);
+        _attr = _next_attr;
     }
 }
 
 //------------------------------------------------------------------------------
 void WinScreenBuffer::flush()
 {
+    sync();
+    if (!_dirty)
+        return;
+
+    _dirty = false;
+
     // When writing to the console conhost.exe will restart the cursor blink
     // timer and hide it which can be disorientating, especially when moving
     // around a line. The below will make sure it stays visible.
@@ -78,9 +98,20 @@ int32 WinScreenBuffer::get_rows() const
     return (csbi.srWindow.Bottom - csbi.srWindow.Top) + 1;
 }
 
+//------------------------------------------------------------------------------
+void WinScreenBuffer::get_cursor(int32& column, int32& row) const
+{
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    GetConsoleScreenBufferInfo(_handle, &csbi);
+    column = csbi.dwCursorPosition.X - csbi.srWindow.Left;
+    row = csbi.dwCursorPosition.Y - csbi.srWindow.Top;
+}
+
 //------------------------------------------------------------------------------
 void WinScreenBuffer::clear(ClearType Type)
 {
+    sync();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(_handle, &csbi);
 
@@ -120,6 +151,8 @@ void WinScreenBuffer::clear(ClearType Type)
 //------------------------------------------------------------------------------
 void WinScreenBuffer::clear_line(ClearType Type)
 {
+    sync();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(_handle, &csbi);
 
@@ -151,6 +184,8 @@ void WinScreenBuffer::clear_line(ClearType Type)
 //------------------------------------------------------------------------------
 void WinScreenBuffer::set_cursor(int32 column, int32 row)
 {
+    sync();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(_handle, &csbi);
 
@@ -168,6 +203,8 @@ void WinScreenBuffer::set_cursor(int32 column, int32 row)
 //------------------------------------------------------------------------------
 void WinScreenBuffer::move_cursor(int32 dx, int32 dy)
 {
+    sync();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(_handle, &csbi);
 
@@ -184,6 +221,8 @@ void WinScreenBuffer::insert_chars(int32 count)
     if (count <= 0)
         return;
 
+    sync();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(_handle, &csbi);
 
@@ -207,6 +246,8 @@ void WinScreenBuffer::delete_chars(int32 count)
     if (count <= 0)
         return;
 
+    sync();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(_handle, &csbi);
 
@@ -238,15 +279,17 @@ void WinScreenBuffer::delete_chars(int32 count)
 //------------------------------------------------------------------------------
 void WinScreenBuffer::set_attributes(const Attributes attr)
 {
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
-    GetConsoleScreenBufferInfo(_handle, &csbi);
-
-    int32 out_attr = csbi.wAttributes & attr_mask_all;
-
-    // Note to self; lookup table is probably much faster.
-    auto swizzle = [] (int32 rgbi) {
-        int32 b_r_ = ((rgbi & 0x01) << 2) | !!(rgbi & 0x04);
-        return (rgbi & 0x0a) | b_r_;
+    // Attributes are tracked here rather than queried and are only applied
+    // when there's text to be written with them.
+    int32 out_attr = _next_attr & attr_mask_all;
+
+    // Colours are quantized to the sixteen basic ones (precomputed tables, see
+    // Colour::as_16) and then the red and blue bits swapped for the console.
+    static const uint8 ansi_to_console[] = {
+        0, 4, 2, 6, 1, 5, 3, 7, 8, 12, 10, 14, 9, 13, 11, 15,
+    };
+    auto swizzle = [] (const Attributes::Colour& colour) {
+        return int32(ansi_to_console[colour.as_16()]);
     };
 
     // Bold
@@ -266,7 +309,7 @@ void WinScreenBuffer::set_attributes(const Attributes attr)
     bool bold = _bold;
     if (auto fg = attr.get_fg())
     {
-        int32 value = fg.is_default ? _default_attr : swizzle(fg->value);
+        int32 value = fg.is_default ? _default_attr : swizzle(fg.value);
         value &= attr_mask_fg;
         out_attr = (out_attr & attr_mask_bg) | value;
         bold |= (value > 7);
@@ -282,12 +325,10 @@ void WinScreenBuffer::set_attributes(const Attributes attr)
     // Background Colour
     if (auto bg = attr.get_bg())
     {
-        int32 value = bg.is_default ? _default_attr : (swizzle(bg->value) << 4);
+        int32 value = bg.is_default ? _default_attr : (swizzle(bg.value) << 4);
         out_attr = (out_attr & attr_mask_fg) | (value & attr_mask_bg);
     }
 
-    // TODO: add rgb/xterm256 support back.
-
-    out_attr |= csbi.wAttributes & ~attr_mask_all;
-    SetConsoleTextAttribute(_handle, int16(out_attr));
+    out_attr |= _next_attr & ~attr_mask_all;
+    _next_attr = uint16(out_attr);
 }
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "frame_buffer.h"
 #include "screen_buffer.h"
 
 //------------------------------------------------------------------------------
@@ -12,10 +13,11 @@ class WinScreenBuffer
 public:
     virtual void    begin() override;
     virtual void    end() override;
-    virtual void    write(const char* data, int32 length) override;
+    virtual int32   write(const char* data, int32 length) override;
     virtual void    flush() override;
     virtual int32   get_columns() const override;
     virtual int32   get_rows() const override;
+    virtual void    get_cursor(int32& column, int32& row) const override;
     virtual void    clear(ClearType Type) override;
     virtual void    clear_line(ClearType Type) override;
     virtual void    set_cursor(int32 column, int32 row) override;
@@ -34,8 +36,13 @@ private:
         attr_mask_all       = attr_mask_fg|attr_mask_bg|attr_mask_underline,
     };
 
+    void            sync();
+    FrameBuffer     _frame;
     void*           _handle = nullptr;
     uint32          _prev_mode = 0;
     uint16          _default_attr = 0x07;
+    uint16          _attr = 0x07;
+    uint16          _next_attr = 0x07;
     bool            _bold = false;
+    bool            _dirty = false;
 };
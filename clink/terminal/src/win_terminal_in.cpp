@@ -7,6 +7,7 @@
 #include <core/base.h>
 #include <core/settings.h>
 #include <core/str.h>
+#include <core/trace.h>
 
 #include <Windows.h>
 
@@ -66,8 +67,6 @@ static const char* const kfx[]   = {
 enum : uint8
 {
     input_abort_byte    = 0xff,
-    input_none_byte     = 0xfe,
-    input_timeout_byte  = 0xfd,
 };
 
 
@@ -117,32 +116,106 @@ static void adjust_cursor_on_resize(COORD prev_position)
 //------------------------------------------------------------------------------
 void WinTerminalIn::begin()
 {
-    _buffer_count = 0;
+    _timed_out = false;
+    _paused = false;
+    _seq_length = 0;
+    _queue.clear();
+
     _stdin = GetStdHandle(STD_INPUT_HANDLE);
     DWORD prev_mode;
     GetConsoleMode(_stdin, &prev_mode);
     _prev_mode = prev_mode;
     set_cursor_visibility(false);
+
+    // Clear 'processed input' flag so key presses such as Ctrl-C and Ctrl-S
+    // aren't swallowed. We also want events about window size changes.
+    SetConsoleMode(_stdin, ENABLE_WINDOW_INPUT);
+
+    // Input's read and decoded on a thread of its own. Keys queue up while the
+    // editor's busy and the editor can cheaply tell if there's more to come.
+    _stop_event = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    _ready_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    _resume_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    _space_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    auto thunk = [] (void* param) -> DWORD {
+        auto* self = (WinTerminalIn*)param;
+        self->run_input_thread();
+
+        // A thread's started for each line so its trace ring's handed on.
+        trace::release();
+        return 0;
+    };
+
+    _thread = CreateThread(nullptr, 0, thunk, this, 0, nullptr);
 }
 
 //------------------------------------------------------------------------------
 void WinTerminalIn::end()
 {
+    SetEvent(_stop_event);
+    WaitForSingleObject(_thread, INFINITE);
+
+    for (void* handle : { _thread, _stop_event, _ready_event, _resume_event, _space_event })
+        CloseHandle(handle);
+
+    _thread = _stop_event = _ready_event = _resume_event = _space_event = nullptr;
+    _queue.clear();
+
     set_cursor_visibility(true);
     SetConsoleMode(_stdin, _prev_mode);
     _stdin = nullptr;
 }
 
 //------------------------------------------------------------------------------
-void WinTerminalIn::select()
+void WinTerminalIn::select(int32 timeout)
+{
+    _timed_out = false;
+    if (!_queue.empty())
+        return;
+
+    // The editor's caught up so the input thread can carry on past an Enter.
+    SetEvent(_resume_event);
+
+    // Hide the cursor unless we're accepting input so we don't have to see it
+    // jump around as the screen's drawn.
+    struct CursorScope {
+        CursorScope()   { set_cursor_visibility(true); }
+        ~CursorScope() { set_cursor_visibility(false); }
+    } _cs;
+
+    // Conhost restarts the cursor blink when writing to the console. It restarts
+    // hidden which means that if you Type faster than the blink the cursor turns
+    // invisible. Fortunately, moving the cursor restarts the blink on visible.
+    HANDLE stdout_handle = GetStdHandle(STD_OUTPUT_HANDLE);
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    GetConsoleScreenBufferInfo(stdout_handle, &csbi);
+    SetConsoleCursorPosition(stdout_handle, csbi.dwCursorPosition);
+
+    DWORD wait_ms = (timeout >= 0) ? DWORD(timeout) : INFINITE;
+    if (WaitForSingleObject(_ready_event, wait_ms) == WAIT_TIMEOUT)
+    {
+        _timed_out = true;
+        return;
+    }
+
+    // Windows will move the cursor onto a new line when it gets clipped on
+    // buffer resize. Other terminals clamp along the X axis.
+    if (get_dimensions() != _dimensions)
+        adjust_cursor_on_resize(csbi.dwCursorPosition);
+}
+
+//------------------------------------------------------------------------------
+bool WinTerminalIn::has_input() const
 {
-    if (!_buffer_count)
-        read_console();
+    return !_queue.empty();
 }
 
 //------------------------------------------------------------------------------
 int32 WinTerminalIn::read()
 {
+    TRACE_SCOPE("TerminalIn::read");
+
     uint32 dimensions = get_dimensions();
     if (dimensions != _dimensions)
     {
@@ -150,98 +223,120 @@ int32 WinTerminalIn::read()
         return TerminalIn::input_terminal_resize;
     }
 
-    if (!_buffer_count)
-        return TerminalIn::input_none;
+    uint8 c;
+    if (!_queue.pop(c))
+    {
+        if (!_timed_out)
+            return TerminalIn::input_none;
+
+        _timed_out = false;
+        return TerminalIn::input_timeout;
+    }
+
+    // Let the input thread know if it's waiting for room in the queue.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_space_wanted.load(std::memory_order_relaxed) && _space_wanted.exchange(false))
+        SetEvent(_space_event);
 
-    uint8 c = pop();
     switch (c)
     {
-    case input_none_byte:       return TerminalIn::input_none;
-    case input_timeout_byte:    return TerminalIn::input_timeout;
     case input_abort_byte:      return TerminalIn::input_abort;
     default:                    return c;
     }
 }
 
 //------------------------------------------------------------------------------
-void WinTerminalIn::read_console()
+void WinTerminalIn::run_input_thread()
 {
-    // Clear 'processed input' flag so key presses such as Ctrl-C and Ctrl-S
-    // aren't swallowed. We also want events about window size changes.
-    struct ModeScope {
-        HANDLE  handle;
-        DWORD   prev_mode;
+    while (true)
+    {
+        // Reading pauses after an Enter until the editor's caught up, so keys
+        // typed ahead of the next prompt stay in conhost for whoever's next.
+        // Likewise keys wait in conhost while the queue's too full for another.
+        HANDLE handles[] = { _stop_event, _stdin };
+        if (_paused)
+            handles[1] = _resume_event;
+        else if (!has_space())
+            handles[1] = _space_event;
+
+        DWORD ret = WaitForMultipleObjects(sizeof_array(handles), handles, FALSE, INFINITE);
+        if (ret != WAIT_OBJECT_0 + 1)
+            break;
 
-        ModeScope(HANDLE handle) : handle(handle)
+        if (_paused)
         {
-            GetConsoleMode(handle, &prev_mode);
-            SetConsoleMode(handle, ENABLE_WINDOW_INPUT);
+            _paused = false;
+            continue;
         }
 
-        ~ModeScope()
-        {
-            SetConsoleMode(handle, prev_mode);
-        }
-    } _ms(_stdin);
+        if (handles[1] == _space_event)
+            continue;
 
-    // Hide the cursor unless we're accepting input so we don't have to see it
-    // jump around as the screen's drawn.
-    struct CursorScope {
-        CursorScope()   { set_cursor_visibility(true); }
-        ~CursorScope() { set_cursor_visibility(false); }
-    } _cs;
+        if (!read_console())
+            break;
+    }
+}
 
-    // Conhost restarts the cursor blink when writing to the console. It restarts
-    // hidden which means that if you Type faster than the blink the cursor turns
-    // invisible. Fortunately, moving the cursor restarts the blink on visible.
-    HANDLE stdout_handle = GetStdHandle(STD_OUTPUT_HANDLE);
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
-    GetConsoleScreenBufferInfo(stdout_handle, &csbi);
-    SetConsoleCursorPosition(stdout_handle, csbi.dwCursorPosition);
+//------------------------------------------------------------------------------
+bool WinTerminalIn::has_space()
+{
+    // The editor's asked to signal when it takes from the queue before the
+    // queue's checked, so a take in between the two isn't missed.
+    _space_wanted.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_queue.get_count() > queue_size - sizeof_array(_seq))
+        return false;
+
+    _space_wanted.store(false);
+    return true;
+}
 
-    // Read input records sent from the terminal (aka conhost) until some
-    // input has beeen buffered.
-    uint32 buffer_count = _buffer_count;
-    while (buffer_count == _buffer_count)
+//------------------------------------------------------------------------------
+bool WinTerminalIn::read_console()
+{
+    TRACE_SCOPE("WinTerminalIn::read_console");
+
+    DWORD count;
+    INPUT_RECORD record;
+    if (!ReadConsoleInputW(_stdin, &record, 1, &count))
     {
-        DWORD count;
-        INPUT_RECORD record;
-        if (!ReadConsoleInputW(_stdin, &record, 1, &count))
-        {
-            // Handle's probably invalid if ReadConsoleInput() failed.
-            _buffer_count = 1;
-            _buffer[0] = input_abort_byte;
-            return;
-        }
+        // Handle's probably invalid if ReadConsoleInput() failed.
+        _queue.push(input_abort_byte);
+        SetEvent(_ready_event);
+        return false;
+    }
 
-        switch (record.EventType)
+    switch (record.EventType)
+    {
+    case KEY_EVENT:
         {
-        case KEY_EVENT:
+            auto& key_event = record.Event.KeyEvent;
+
+            // Some times conhost can send through ALT codes, with the
+            // resulting Unicode code point in the Alt key-up event.
+            if (!key_event.bKeyDown
+                && key_event.wVirtualKeyCode == VK_MENU
+                && key_event.uChar.UnicodeChar)
             {
-                auto& key_event = record.Event.KeyEvent;
-
-                // Some times conhost can send through ALT codes, with the
-                // resulting Unicode code point in the Alt key-up event.
-                if (!key_event.bKeyDown
-                    && key_event.wVirtualKeyCode == VK_MENU
-                    && key_event.uChar.UnicodeChar)
-                {
-                    key_event.bKeyDown = TRUE;
-                    key_event.dwControlKeyState = 0;
-                }
-
-                if (key_event.bKeyDown)
-                    process_input(key_event);
+                key_event.bKeyDown = TRUE;
+                key_event.dwControlKeyState = 0;
             }
-            break;
 
-        case WINDOW_BUFFER_SIZE_EVENT:
-            // Windows will move the cursor onto a new line when it gets clipped
-            // on buffer resize. Other terminals
-            adjust_cursor_on_resize(csbi.dwCursorPosition);
-            return;
+            if (key_event.bKeyDown)
+            {
+                process_input(key_event);
+                flush();
+            }
         }
+        break;
+
+    case WINDOW_BUFFER_SIZE_EVENT:
+        // Nothing's queued; read() notices the dimensions have changed.
+        SetEvent(_ready_event);
+        break;
     }
+
+    return true;
 }
 
 //------------------------------------------------------------------------------
@@ -282,7 +377,7 @@ void WinTerminalIn::process_input(KEY_EVENT_RECORD const& record)
     }
 
     // Special case for shift-tab (aka. back-tab or kcbt).
-    if (key_char == '\t' && !_buffer_count && (key_flags & SHIFT_PRESSED))
+    if (key_char == '\t' && !_seq_length && (key_flags & SHIFT_PRESSED))
         return push(terminfo::kcbt);
 
     // Function keys (kf1-kf48 from xterm+pcf2)
@@ -395,53 +490,47 @@ void WinTerminalIn::process_input(KEY_EVENT_RECORD const& record)
 //------------------------------------------------------------------------------
 void WinTerminalIn::push(const char* seq)
 {
-    static const uint32 mask = sizeof_array(_buffer) - 1;
-
-    if (_buffer_count >= sizeof_array(_buffer))
-        return;
-
-    int32 index = _buffer_head + _buffer_count;
-    for (; _buffer_count <= mask && *seq; ++_buffer_count, ++index, ++seq)
-        _buffer[index & mask] = *seq;
+    for (; _seq_length < sizeof_array(_seq) && *seq; ++seq)
+        _seq[_seq_length++] = *seq;
 }
 
 //------------------------------------------------------------------------------
 void WinTerminalIn::push(uint32 value)
 {
-    static const uint32 mask = sizeof_array(_buffer) - 1;
-
-    if (_buffer_count >= sizeof_array(_buffer))
-        return;
-
-    int32 index = _buffer_head + _buffer_count;
-
     if (value < 0x80)
     {
-        _buffer[index & mask] = value;
-        ++_buffer_count;
+        if (_seq_length < sizeof_array(_seq))
+            _seq[_seq_length++] = value;
         return;
     }
 
     wchar_t wc[2] = { (wchar_t)value, 0 };
-    char utf8[mask + 1];
+    char utf8[sizeof_array(_seq)];
     uint32 n = to_utf8(utf8, sizeof_array(utf8), wc);
-    if (n <= uint32(mask - _buffer_count))
-        for (uint32 i = 0; i < n; ++i, ++index)
-            _buffer[index & mask] = utf8[i];
-
-    _buffer_count += n;
+    if (n <= uint32(sizeof_array(_seq) - _seq_length))
+        for (uint32 i = 0; i < n; ++i)
+            _seq[_seq_length++] = utf8[i];
 }
 
 //------------------------------------------------------------------------------
-uint8 WinTerminalIn::pop()
+void WinTerminalIn::flush()
 {
-    if (!_buffer_count)
-        return input_none_byte;
-
-    uint8 value = _buffer[_buffer_head];
-
-    --_buffer_count;
-    _buffer_head = (_buffer_head + 1) & (sizeof_array(_buffer) - 1);
+    if (!_seq_length)
+        return;
 
-    return value;
+    // A key's sequence is queued whole so the editor never sees part of one.
+    // There's always room for it; console input isn't read until there is.
+    //
+    // Reading pauses after an Enter. The editor signals resume whenever it
+    // finds the queue empty, so a signal from before the Enter is cleared
+    // before the editor can see it.
+    bool enter = (_seq[_seq_length - 1] == '\r');
+    if (enter)
+        ResetEvent(_resume_event);
+
+    _queue.push(_seq, _seq_length);
+    _paused = enter;
+
+    _seq_length = 0;
+    SetEvent(_ready_event);
 }
@@ -5,6 +5,10 @@
 
 #include "terminal_in.h"
 
+#include <core/spsc_queue.h>
+
+#include <atomic>
+
 //------------------------------------------------------------------------------
 class WinTerminalIn
     : public TerminalIn
@@ -12,19 +16,31 @@ class WinTerminalIn
 public:
     virtual void    begin() override;
     virtual void    end() override;
-    virtual void    select() override;
+    virtual void    select(int32 timeout=-1) override;
+    virtual bool    has_input() const override;
     virtual int32   read() override;
 
 private:
-    void            read_console();
+    enum : uint32 { queue_size = 256 };
+    void            run_input_thread();
+    bool            has_space();
+    bool            read_console();
     void            process_input(const KEY_EVENT_RECORD& key_event);
     void            push(uint32 value);
     void            push(const char* seq);
-    uint8           pop();
+    void            flush();
     void*           _stdin = nullptr;
+    void*           _thread = nullptr;
+    void*           _stop_event = nullptr;
+    void*           _ready_event = nullptr;
+    void*           _resume_event = nullptr;
+    void*           _space_event = nullptr;
     uint32          _dimensions = 0;
     uint32          _prev_mode = 0;
-    uint8           _buffer_head = 0;
-    uint8           _buffer_count = 0;
-    uint8           _buffer[16]; // must be power of two.
+    bool            _timed_out = false;
+    bool            _paused = false;          // only used by the input thread.
+    std::atomic<bool> _space_wanted = {};     // input thread -> editor thread.
+    uint8           _seq_length = 0;
+    uint8           _seq[16];                 // only used by the input thread.
+    SpscQueue<uint8, queue_size> _queue;      // input thread -> editor thread.
 };
@@ -5,7 +5,7 @@
 #include "win_terminal_out.h"
 
 #include <core/base.h>
-#include <core/str_iter.h>
+#include <core/trace.h>
 
 #include <Windows.h>
 
@@ -25,33 +25,32 @@ void WinTerminalOut::begin()
 //------------------------------------------------------------------------------
 void WinTerminalOut::end()
 {
+    _frame.flush(_stdout);
     SetConsoleTextAttribute(_stdout, _default_attr);
     SetConsoleMode(_stdout, _prev_mode);
     _stdout = nullptr;
 }
 
 //------------------------------------------------------------------------------
-void WinTerminalOut::write(const char* chars, int32 length)
+int32 WinTerminalOut::write(const char* chars, int32 length)
 {
-    StrIter iter(chars, length);
-    while (length > 0)
-    {
-        wchar_t wbuf[384];
-        int32 n = min<int32>(sizeof_array(wbuf), length + 1);
-        n = to_utf16(wbuf, n, iter);
+    // Writes are collected until flush() so a redisplay, escape codes and all,
+    // reaches the console in a single call.
+    int32 written = _frame.append(chars, length);
+    if (_frame.get_length() >= FrameBuffer::flush_size)
+        _frame.flush(_stdout);
 
-        DWORD written;
-        WriteConsoleW(_stdout, wbuf, n, &written, nullptr);
-
-        n = int32(iter.get_pointer() - chars);
-        length -= n;
-        chars += n;
-    }
+    return written;
 }
 
 //------------------------------------------------------------------------------
 void WinTerminalOut::flush()
 {
+    TRACE_SCOPE("TerminalOut::flush");
+
+    if (!_frame.flush(_stdout))
+        return;
+
     // When writing to the console conhost.exe will restart the cursor blink
     // timer and hide it which can be disorientating, especially when moving
     // around a line. The below will make sure it stays visible.
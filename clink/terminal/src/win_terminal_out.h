@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "frame_buffer.h"
 #include "terminal_out.h"
 
 //------------------------------------------------------------------------------
@@ -12,12 +13,13 @@ class WinTerminalOut
 public:
     virtual void    begin() override;
     virtual void    end() override;
-    virtual void    write(const char* chars, int32 length) override;
+    virtual int32   write(const char* chars, int32 length) override;
     virtual void    flush() override;
     virtual int32   get_columns() const override;
     virtual int32   get_rows() const override;
 
 private:
+    FrameBuffer     _frame;
     void*           _stdout = nullptr;
     uint32          _prev_mode = 0;
     uint16          _default_attr = 0x07;
@@ -144,3 +144,45 @@ TEST_CASE("Attributes : diff")
     REQUIRE(diff.get_fg()->value == 1);
     REQUIRE(!diff.get_bg());
 }
+
+TEST_CASE("Attributes : colour")
+{
+    Attributes::Colour colour;
+    uint8 rgb[3];
+
+    SECTION("Palette")
+    {
+        colour.value = 196;
+        colour.as_888(rgb);
+        REQUIRE(rgb[0] == 255 && rgb[1] == 0 && rgb[2] == 0);
+
+        colour.value = 244;
+        colour.as_888(rgb);
+        REQUIRE(rgb[0] == 128 && rgb[1] == 128 && rgb[2] == 128);
+
+        colour.value = 3;
+        REQUIRE(colour.as_16() == colour_yellow);
+
+        colour.value = 196;
+        REQUIRE(colour.as_16() == colour_light_red);
+
+        colour.value = 18;
+        REQUIRE(colour.as_16() == colour_blue);
+    }
+
+    SECTION("RGB")
+    {
+        Attributes attr;
+        attr.set_fg(0, 255, 0);
+        REQUIRE(attr.get_fg()->as_16() == colour_light_green);
+
+        attr.set_fg(0, 120, 130);
+        REQUIRE(attr.get_fg()->as_16() == colour_cyan);
+
+        attr.set_fg(190, 190, 190);
+        REQUIRE(attr.get_fg()->as_16() == colour_grey);
+
+        attr.set_fg(10, 10, 10);
+        REQUIRE(attr.get_fg()->as_16() == colour_black);
+    }
+}
@@ -27,6 +27,70 @@ TEST_CASE("ecma48 chars")
     REQUIRE(!iter.next());
 }
 
+//------------------------------------------------------------------------------
+TEST_CASE("ecma48 chars (long)")
+{
+    char input[96];
+    for (int32 i = 0; i < sizeof_array(input) - 1; ++i)
+        input[i] = 'a' + (i % 26);
+    input[sizeof_array(input) - 1] = '\0';
+
+    // A control code at each offset either side of the 16 byte boundaries.
+    for (int32 i = 1; i < 40; ++i)
+    {
+        char c = input[i];
+        input[i] = '\x1b';
+
+        Ecma48Iter iter(input, g_state);
+        const Ecma48Code* code = &iter.next();
+        REQUIRE(code->get_type() == Ecma48Code::type_chars);
+        REQUIRE(code->get_pointer() == input);
+        REQUIRE(code->get_length() == i, [&] () { printf("offset: %d", i); });
+
+        code = &iter.next();
+        REQUIRE(code->get_type() == Ecma48Code::type_icf);
+        REQUIRE(code->get_code() == input[i + 1]);
+
+        input[i] = c;
+    }
+
+    SECTION("Length")
+    {
+        input[80] = '\n';
+        Ecma48Iter iter(input, g_state, 50);
+        const Ecma48Code* code = &iter.next();
+        REQUIRE(code->get_type() == Ecma48Code::type_chars);
+        REQUIRE(code->get_length() == 50);
+        REQUIRE(!iter.next());
+    }
+
+    SECTION("Unaligned")
+    {
+        input[70] = '\n';
+        Ecma48Iter iter(input + 3, g_state);
+        const Ecma48Code* code = &iter.next();
+        REQUIRE(code->get_type() == Ecma48Code::type_chars);
+        REQUIRE(code->get_length() == 67);
+
+        code = &iter.next();
+        REQUIRE(code->get_type() == Ecma48Code::type_c0);
+        REQUIRE(code->get_code() == '\n');
+    }
+
+    SECTION("UTF-8")
+    {
+        const char* utf8 = "\xc3\xa9\xe2\x82\xac\xc2\x9cxyz\xe2\x82\xac\x07";
+        Ecma48Iter iter(utf8, g_state);
+        const Ecma48Code* code = &iter.next();
+        REQUIRE(code->get_type() == Ecma48Code::type_chars);
+        REQUIRE(code->get_length() == 13);
+
+        code = &iter.next();
+        REQUIRE(code->get_type() == Ecma48Code::type_c0);
+        REQUIRE(code->get_code() == 0x07);
+    }
+}
+
 //------------------------------------------------------------------------------
 TEST_CASE("ecma48 c0")
 {
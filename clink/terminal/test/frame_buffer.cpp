@@ -0,0 +1,67 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/base.h>
+#include <terminal/frame_buffer.h>
+
+//------------------------------------------------------------------------------
+TEST_CASE("Frame buffer")
+{
+    FrameBuffer frame;
+    REQUIRE(frame.empty());
+
+    SECTION("Append")
+    {
+        REQUIRE(frame.append("abc", 3) == 3);
+        REQUIRE(frame.append("\x1b[1mxyz", -1) == 7);
+        REQUIRE(frame.append("", 0) == 0);
+        REQUIRE(frame.get_length() == 10);
+        REQUIRE(wcsncmp(frame.get_data(), L"abc\x1b[1mxyz", 10) == 0);
+    }
+
+    SECTION("UTF-8")
+    {
+        REQUIRE(frame.append("\xc3\xa4\xe2\x82\xac", 5) == 5);
+        REQUIRE(frame.append("\xf0\x9f\x98\x80", 4) == 4);
+        REQUIRE(frame.get_length() == 4);
+
+        const wchar_t* data = frame.get_data();
+        REQUIRE(data[0] == 0x00e4);
+        REQUIRE(data[1] == 0x20ac);
+        REQUIRE(data[2] == 0xd83d);
+        REQUIRE(data[3] == 0xde00);
+    }
+
+    SECTION("Grow")
+    {
+        char chunk[] = "0123456789abcdef";
+        for (int32 i = 0; i < 1000; ++i)
+            REQUIRE(frame.append(chunk, 16) == 16);
+
+        REQUIRE(frame.get_length() == 16000);
+        REQUIRE(frame.get_data()[15999] == 'f');
+
+        frame.clear();
+        REQUIRE(frame.empty());
+    }
+
+    SECTION("Chunks")
+    {
+        // A surrogate pair that straddles the end of a chunk starts the next.
+        char chunk[] = "0123456789abcdef";
+        for (uint32 i = 0; i < (FrameBuffer::flush_size / 16) - 1; ++i)
+            REQUIRE(frame.append(chunk, 16) == 16);
+
+        REQUIRE(frame.append(chunk, 15) == 15);
+        REQUIRE(frame.append("\xf0\x9f\x98\x80", 4) == 4);
+
+        const wchar_t* data = frame.get_data();
+        uint32 length = frame.get_length();
+        REQUIRE(length == FrameBuffer::flush_size + 1);
+        REQUIRE(FrameBuffer::get_chunk_length(data, length) == FrameBuffer::flush_size - 1);
+        REQUIRE(FrameBuffer::get_chunk_length(data + 1, length - 1) == FrameBuffer::flush_size);
+        REQUIRE(FrameBuffer::get_chunk_length(data, 10) == 10);
+    }
+}
@@ -0,0 +1,145 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/str.h>
+#include <terminal/ecma48_terminal_out.h>
+#include <terminal/headless_screen_buffer.h>
+#include <terminal/printer.h>
+
+//------------------------------------------------------------------------------
+TEST_CASE("Headless screen")
+{
+    HeadlessScreenBuffer screen(20, 4);
+    Ecma48TerminalOut ecma48(screen);
+    TerminalOut& terminal = ecma48;
+    terminal.begin();
+
+    auto check = [&] (const char* expected) {
+        Str<256> snapshot;
+        screen.snapshot(snapshot);
+        REQUIRE(snapshot.equals(expected), [&] () {
+            printf("expected; %s#\n", expected);
+            printf("     got; %s#\n", snapshot.c_str());
+        });
+    };
+
+    SECTION("Chars")
+    {
+        terminal.write("hello\r\nworld");
+        check("hello\nworld");
+
+        terminal.write("\rW");
+        check("hello\nWorld");
+    }
+
+    SECTION("Wrap")
+    {
+        terminal.write("0123456789abcdefghijKLM");
+        check("0123456789abcdefghij\nKLM");
+    }
+
+    SECTION("Scroll")
+    {
+        terminal.write("a\nb\nc\nd\ne");
+        check("b\nc\nd\ne");
+    }
+
+    SECTION("Cursor")
+    {
+        terminal.write("abc\x1b[2;5Hx\x1b[A\x1b[2Dy");
+        check("abcy\n    x");
+        REQUIRE(screen.get_stats().cursor_moves == 3);
+    }
+
+    SECTION("Erase")
+    {
+        SECTION("EL") { terminal.write("abcdef\x1b[1;3H\x1b[K");   check("ab"); }
+        SECTION("EL1") { terminal.write("abcdef\x1b[1;3H\x1b[1K");  check("   def"); }
+        SECTION("ED") { terminal.write("abc\ndef\x1b[1;2H\x1b[J");  check("a"); }
+        SECTION("ED2") { terminal.write("abc\ndef\x1b[2J");         check(""); }
+    }
+
+    SECTION("Insert/delete")
+    {
+        terminal.write("abcdef\x1b[1;2H\x1b[2@");
+        check("a  bcdef");
+
+        terminal.write("\x1b[3P");
+        check("acdef");
+    }
+
+    SECTION("SGR")
+    {
+        terminal.write("\x1b[31mr\x1b[0md");
+
+        Attributes attr = screen.get_grid().get_cell(0, 0).attr;
+        REQUIRE(attr.get_fg()->value == 1);
+
+        attr = screen.get_grid().get_cell(1, 0).attr;
+        REQUIRE(attr.get_fg().is_default);
+    }
+
+    SECTION("SGR extended")
+    {
+        terminal.write("\x1b[38;5;196ma\x1b[48;2;10;20;30;1mb\x1b[38;5mc");
+
+        Attributes attr = screen.get_grid().get_cell(0, 0).attr;
+        REQUIRE(!attr.get_fg()->is_rgb);
+        REQUIRE(attr.get_fg()->value == 196);
+
+        attr = screen.get_grid().get_cell(1, 0).attr;
+        REQUIRE(attr.get_bg()->is_rgb);
+        REQUIRE(attr.get_bg()->r == (10 >> 3));
+        REQUIRE(attr.get_bg()->g == (20 >> 3));
+        REQUIRE(attr.get_bg()->b == (30 >> 3));
+        REQUIRE(attr.get_bold().value);
+
+        // Malformed; missing palette index.
+        attr = screen.get_grid().get_cell(2, 0).attr;
+        REQUIRE(attr.get_fg()->value == 196);
+    }
+
+    SECTION("SGR printer")
+    {
+        Attributes attr;
+        attr.set_fg(200, 100, 50);
+        attr.set_bg(240);
+
+        Printer printer(terminal);
+        printer.print(attr, "x", 1);
+
+        attr = screen.get_grid().get_cell(0, 0).attr;
+        REQUIRE(attr.get_fg()->is_rgb);
+        REQUIRE(attr.get_fg()->r == (200 >> 3));
+        REQUIRE(attr.get_fg()->g == (100 >> 3));
+        REQUIRE(attr.get_fg()->b == (50 >> 3));
+        REQUIRE(!attr.get_bg()->is_rgb);
+        REQUIRE(attr.get_bg()->value == 240);
+    }
+
+    SECTION("Wide")
+    {
+        terminal.write("\xe4\xb8\xadx");
+        check("\xe4\xb8\xadx");
+        REQUIRE(screen.get_grid().get_cell(1, 0).width == 0);
+        REQUIRE(screen.get_grid().get_cell(2, 0).c == 'x');
+    }
+
+    SECTION("Stats")
+    {
+        terminal.write("ab\x1b[1mcd");
+        terminal.flush();
+
+        const HeadlessScreenBuffer::Stats& stats = screen.get_stats();
+        REQUIRE(stats.bytes == 4);
+        REQUIRE(stats.writes == 2);
+        REQUIRE(stats.flushes == 1);
+
+        screen.reset_stats();
+        REQUIRE(screen.get_stats().bytes == 0);
+    }
+
+    terminal.end();
+}
@@ -0,0 +1,106 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/str.h>
+#include <terminal/headless_screen_buffer.h>
+#include <terminal/virtual_screen_buffer.h>
+
+//------------------------------------------------------------------------------
+class RecordingScreen
+    : public HeadlessScreenBuffer
+{
+public:
+                    RecordingScreen() : HeadlessScreenBuffer(20, 4) {}
+    virtual int32   write(const char* data, int32 length) override;
+    virtual void    set_cursor(int32 column, int32 row) override;
+    Str<256>        written;
+    int32           cursor_moves = 0;
+};
+
+//------------------------------------------------------------------------------
+int32 RecordingScreen::write(const char* data, int32 length)
+{
+    written.concat(data, length);
+    return HeadlessScreenBuffer::write(data, length);
+}
+
+//------------------------------------------------------------------------------
+void RecordingScreen::set_cursor(int32 column, int32 row)
+{
+    ++cursor_moves;
+    HeadlessScreenBuffer::set_cursor(column, row);
+}
+
+
+
+//------------------------------------------------------------------------------
+TEST_CASE("Virtual screen")
+{
+    RecordingScreen target;
+    VirtualScreenBuffer screen(target);
+    screen.begin();
+
+    screen.write("hello", 5);
+    screen.flush();
+    REQUIRE(target.written.equals("hello"));
+
+    auto redraw = [&] (const char* line) {
+        target.written.clear();
+        target.cursor_moves = 0;
+        screen.move_cursor(INT_MIN, 0);
+        screen.write(line, -1);
+        screen.flush();
+    };
+
+    SECTION("Unchanged")
+    {
+        redraw("hello");
+        REQUIRE(target.written.empty());
+    }
+
+    SECTION("Changed cell")
+    {
+        redraw("help");
+        REQUIRE(target.written.equals("p"));
+        REQUIRE(target.cursor_moves == 1);
+    }
+
+    SECTION("Bridged")
+    {
+        redraw("jelly");
+        REQUIRE(target.written.equals("jelly"));
+        REQUIRE(target.cursor_moves == 1);
+    }
+
+    SECTION("Cleared")
+    {
+        target.written.clear();
+        screen.move_cursor(-2, 0);
+        screen.clear_line(ScreenBuffer::clear_type_after);
+        screen.flush();
+        REQUIRE(strncmp(target.written.c_str(), "  ", 2) == 0);
+        REQUIRE(target.get_grid().get_cell(2, 0).c == 'l');
+        REQUIRE(target.get_grid().get_cell(3, 0).c == ' ');
+    }
+
+    SECTION("Scrolled")
+    {
+        target.written.clear();
+        screen.write("\n\n\n\nabc", -1);
+        screen.flush();
+        REQUIRE(target.written.equals("\nabc"));
+        REQUIRE(target.get_grid().get_cell(0, 3).c == 'a');
+        REQUIRE(target.get_grid().get_cell(0, 0).c == ' ');
+    }
+
+    // The target's cursor should end up where the virtual one is.
+    int32 column, row, target_column, target_row;
+    screen.get_cursor(column, row);
+    target.get_cursor(target_column, target_row);
+    REQUIRE(column == target_column);
+    REQUIRE(row == target_row);
+
+    screen.end();
+}
@@ -0,0 +1,94 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <terminal/ecma48_iter.h>
+#include <terminal/wcwidth.h>
+
+//------------------------------------------------------------------------------
+TEST_CASE("wcwidth")
+{
+    SECTION("ASCII")
+    {
+        REQUIRE(wcwidth(0) == 0);
+        REQUIRE(wcwidth('\t') == -1);
+        REQUIRE(wcwidth(' ') == 1);
+        REQUIRE(wcwidth('~') == 1);
+        REQUIRE(wcwidth(0x7f) == -1);
+        REQUIRE(wcwidth(0x9b) == -1);
+    }
+
+    SECTION("Zero width")
+    {
+        REQUIRE(wcwidth(0x0301) == 0);      // combining acute
+        REQUIRE(wcwidth(0x200b) == 0);      // zero width space
+        REQUIRE(wcwidth(0x200d) == 0);      // zero width joiner
+        REQUIRE(wcwidth(0xfe0f) == 0);      // VS16
+        REQUIRE(wcwidth(0x1160) == 0);      // Hangul Jungseong filler
+        REQUIRE(wcwidth(0x00ad) == 1);      // soft hyphen
+    }
+
+    SECTION("Wide")
+    {
+        REQUIRE(wcwidth(0x4e2d) == 2);
+        REQUIRE(wcwidth(0xac00) == 2);
+        REQUIRE(wcwidth(0xff21) == 2);
+        REQUIRE(wcwidth(0x1f600) == 2);     // emoji
+        REQUIRE(wcwidth(0x2fffd) == 2);     // unassigned but in a CJK plane
+        REQUIRE(wcwidth(0x00e9) == 1);
+        REQUIRE(wcwidth(0x2764) == 1);      // text presentation by default
+        REQUIRE(wcwidth(0x110000) == 1);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("wcwidth clusters")
+{
+    SECTION("Plain")
+    {
+        REQUIRE(cell_count("abc") == 3);
+        REQUIRE(cell_count("\x1b[1mab\x1b[0mc") == 3);
+        REQUIRE(cell_count("e\xcc\x81") == 1);
+        REQUIRE(cell_count("\xe4\xb8\xad\xe6\x96\x87") == 4);
+
+        // ASCII spans either side of block boundaries.
+        REQUIRE(cell_count("0123456789abcdefghijklmnopqrstu\xe4\xb8\xadvwxyz") == 38);
+        REQUIRE(cell_count("0123456789abcdef\x1b[1m\xe4\xb8\xad0123456789abcdefghij") == 38);
+    }
+
+    SECTION("VS16")
+    {
+        REQUIRE(cell_count("\xe2\x9d\xa4") == 1);
+        REQUIRE(cell_count("\xe2\x9d\xa4\xef\xb8\x8f") == 2);
+        REQUIRE(cell_count("1\xef\xb8\x8f\xe2\x83\xa3") == 2);   // keycap
+    }
+
+    SECTION("ZWJ")
+    {
+        // man ZWJ woman ZWJ girl
+        REQUIRE(cell_count("\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x91\xa7") == 2);
+
+        // rainbow flag; white flag VS16 ZWJ rainbow
+        REQUIRE(cell_count("\xf0\x9f\x8f\xb3\xef\xb8\x8f\xe2\x80\x8d\xf0\x9f\x8c\x88") == 2);
+
+        // ZWJ between narrow characters doesn't join them.
+        REQUIRE(cell_count("a\xe2\x80\x8d" "b") == 2);
+    }
+
+    SECTION("Skin tone")
+    {
+        REQUIRE(cell_count("\xf0\x9f\x91\x8b\xf0\x9f\x8f\xbd") == 2);
+        REQUIRE(cell_count("\xf0\x9f\x8f\xbd") == 2);
+    }
+
+    SECTION("Reset")
+    {
+        ClusterWidth cluster;
+        REQUIRE(cluster.next(0x1f600) == 2);
+        cluster.reset();
+        REQUIRE(cluster.next(0xfe0f) == 0);
+        REQUIRE(cluster.next('x') == 1);
+        REQUIRE(cluster.next(0xfe0f) == 1);
+    }
+}
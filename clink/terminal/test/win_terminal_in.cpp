@@ -0,0 +1,119 @@
+// Copyright (c) Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/base.h>
+#include <core/str.h>
+#include <terminal/terminal.h>
+#include <terminal/terminal_in.h>
+
+//------------------------------------------------------------------------------
+static void write_keys(HANDLE handle, const char* keys)
+{
+    for (; *keys; ++keys)
+    {
+        INPUT_RECORD record = {};
+        record.EventType = KEY_EVENT;
+        record.Event.KeyEvent.bKeyDown = TRUE;
+        record.Event.KeyEvent.wRepeatCount = 1;
+        record.Event.KeyEvent.wVirtualKeyCode = (*keys == '\r') ? VK_RETURN : 0;
+        record.Event.KeyEvent.uChar.UnicodeChar = *keys;
+
+        DWORD written;
+        WriteConsoleInputW(handle, &record, 1, &written);
+    }
+}
+
+//------------------------------------------------------------------------------
+static int32 read_line(TerminalIn& in, StrBase& out)
+{
+    while (true)
+    {
+        in.select();
+
+        int32 c = in.read();
+        if (c == TerminalIn::input_abort)
+            return c;
+
+        if (uint32(c) >= 0x80)
+            continue;
+
+        char chars[] = { char(c), 0 };
+        out << chars;
+        if (c == '\r')
+            return c;
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Terminal input")
+{
+    // Only testable when there's a console to put keys in to.
+    HANDLE handle = GetStdHandle(STD_INPUT_HANDLE);
+    DWORD mode;
+    if (!GetConsoleMode(handle, &mode))
+        return;
+
+    SECTION("After Enter")
+    {
+        FlushConsoleInputBuffer(handle);
+
+        Terminal terminal = terminal_create();
+        TerminalIn& in = *terminal.in;
+        in.begin();
+
+        // Finding the queue empty signals the input thread to carry on.
+        in.select(0);
+
+        // Keys after an Enter are left for whoever reads the console next.
+        write_keys(handle, "ab\rcd\r");
+
+        Str<> line;
+        REQUIRE(read_line(in, line) == '\r');
+        REQUIRE(line.equals("ab\r"));
+
+        Sleep(50);
+        in.end();
+
+        DWORD count = 0;
+        GetNumberOfConsoleInputEvents(handle, &count);
+        REQUIRE(count == 3);
+
+        in.begin();
+
+        line.clear();
+        REQUIRE(read_line(in, line) == '\r');
+        REQUIRE(line.equals("cd\r"));
+
+        in.end();
+        terminal_destroy(terminal);
+        FlushConsoleInputBuffer(handle);
+    }
+
+    SECTION("Long input")
+    {
+        FlushConsoleInputBuffer(handle);
+
+        Terminal terminal = terminal_create();
+        TerminalIn& in = *terminal.in;
+        in.begin();
+
+        // More than fits in the queue at once while the editor's busy.
+        Str<> keys;
+        for (int32 i = 0; i < 100; ++i)
+            keys << "0123456789";
+        keys << "\r";
+
+        write_keys(handle, keys.c_str());
+        Sleep(50);
+
+        Str<> line;
+        REQUIRE(read_line(in, line) == '\r');
+        REQUIRE(line.equals(keys.c_str()));
+
+        in.end();
+        terminal_destroy(terminal);
+        FlushConsoleInputBuffer(handle);
+    }
+}
@@ -21,6 +21,7 @@ public:
     virtual void    on_matches_changed(const Context& context) override {}
     virtual void    on_input(const Input& input, Result& result, const Context& context) override {}
     virtual void    on_terminal_resize(int32 columns, int32 rows, const Context& context) override {}
+    virtual void    on_prompt_changed(const Context& context) override {}
 };
 
 
@@ -107,6 +108,12 @@ LineEditor* LineEditorTester::get_editor() const
     return _editor;
 }
 
+//------------------------------------------------------------------------------
+HeadlessScreenBuffer& LineEditorTester::get_screen()
+{
+    return _terminal_out.get_screen();
+}
+
 //------------------------------------------------------------------------------
 void LineEditorTester::set_input(const char* input)
 {
@@ -143,6 +150,10 @@ void LineEditorTester::run(bool expectationless)
     }
     while (_terminal_in.has_input());
 
+    // Generators that are still running are resumed until they've finished.
+    while (_editor->is_pending())
+        REQUIRE(_editor->update());
+
     if (_has_matches)
     {
         const Matches* matches = match_catch.get_matches();
@@ -5,6 +5,8 @@
 
 #include <lib/line_editor.h>
 #include <lib/line_buffer.h>
+#include <terminal/ecma48_terminal_out.h>
+#include <terminal/headless_screen_buffer.h>
 #include <terminal/terminal_in.h>
 #include <terminal/terminal_out.h>
 
@@ -18,12 +20,12 @@ class TestTerminalIn
     : public TerminalIn
 {
 public:
-    bool                    has_input() const { return (_read == nullptr) ? false : (*_read != '\0'); }
+    virtual bool            has_input() const override { return (_read == nullptr) ? false : (*_read != '\0'); }
     void                    set_input(const char* input) { _input = _read = input; }
     virtual void            begin() override {}
     virtual void            end() override {}
-    virtual void            select() override {}
-    virtual int32           read() override { return *(uint8*)_read++; }
+    virtual void            select(int32) override {}
+    virtual int32           read() override { return has_input() ? *(uint8*)_read++ : input_none; }
 
 private:
     const char*             _input = nullptr;
@@ -31,17 +33,23 @@ private:
 };
 
 //------------------------------------------------------------------------------
+// Owns the screen as a base so it's constructed before Ecma48TerminalOut, which
+// is given a reference to it.
+struct TestScreenHolder
+{
+    HeadlessScreenBuffer    _screen_buffer;
+};
+
+//------------------------------------------------------------------------------
+// Output is interpreted into an in-memory screen so what the editor draws can
+// be inspected.
 class TestTerminalOut
-    : public TerminalOut
+    : private TestScreenHolder
+    , public Ecma48TerminalOut
 {
 public:
-    virtual void            begin() override {}
-    virtual void            end() override {}
-    virtual void            write(const char* chars, int32 length) override {}
-    virtual void            flush() override {}
-    virtual int32           get_columns() const override { return 80; }
-    virtual int32           get_rows() const override { return 25; }
-    virtual void            set_attributes(const Attributes attr) {}
+                            TestTerminalOut() : Ecma48TerminalOut(_screen_buffer) {}
+    HeadlessScreenBuffer&   get_screen() { return _screen_buffer; }
 };
 
 
@@ -54,6 +62,7 @@ public:
                                 LineEditorTester(const LineEditor::Desc& desc);
                                 ~LineEditorTester();
     LineEditor*                 get_editor() const;
+    HeadlessScreenBuffer&       get_screen();
     void                        set_input(const char* input);
     template <class ...T> void  set_expected_matches(T... t); // T must be const char*
     void                        set_expected_output(const char* expected);
@@ -115,6 +115,7 @@ workspace("clink")
 
     configuration("debug or release")
         defines("CLINK_BUILD_ROOT=\""..path.getabsolute(to).."\"")
+        defines("CLINK_TRACE")
 
     configuration("vs*")
         defines("_HAS_EXCEPTIONS=0")